@@ -0,0 +1,83 @@
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct ArenaBlock {
+    ArenaBlock* next;
+    size_t size;
+    size_t used;
+    _Alignas(ARENA_ALIGN) u8 data[];
+};
+
+static size_t AlignUp(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static ArenaBlock* NewBlock(Arena* arena, size_t size) {
+    ArenaBlock* block = (ArenaBlock*)malloc(sizeof(ArenaBlock) + size);
+    if (!block) return NULL;
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    arena->reserved += size;
+    return block;
+}
+
+static size_t BlockSize(const Arena* arena) {
+    return arena->block_size ? arena->block_size : ARENA_DEFAULT_BLOCK;
+}
+
+bool Arena_Reserve(Arena* arena, size_t size) {
+    size = AlignUp(size);
+    if (arena->head && arena->head->size - arena->head->used >= size) return true;
+
+    ArenaBlock* block = NewBlock(arena, size > BlockSize(arena) ? size : BlockSize(arena));
+    if (!block) return false;
+    block->next = arena->head;
+    arena->head = block;
+    return true;
+}
+
+void* Arena_Alloc(Arena* arena, size_t size) {
+    size = AlignUp(size ? size : 1);
+
+    ArenaBlock* head = arena->head;
+    if (head && head->size - head->used >= size) {
+        void* p = head->data + head->used;
+        head->used += size;
+        return p;
+    }
+
+    // Too big to share a block: give it its own behind the head, so the
+    // rest of the head block is not wasted
+    if (head && size > BlockSize(arena) / 4) {
+        ArenaBlock* block = NewBlock(arena, size);
+        if (!block) return NULL;
+        block->used = size;
+        block->next = head->next;
+        head->next = block;
+        return block->data;
+    }
+
+    if (!Arena_Reserve(arena, size)) return NULL;
+    void* p = arena->head->data + arena->head->used;
+    arena->head->used += size;
+    return p;
+}
+
+void* Arena_AllocZero(Arena* arena, size_t size) {
+    void* p = Arena_Alloc(arena, size);
+    if (p) memset(p, 0, size);
+    return p;
+}
+
+void Arena_Release(Arena* arena) {
+    ArenaBlock* block = arena->head;
+    while (block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->reserved = 0;
+}
@@ -0,0 +1,34 @@
+#ifndef BOOMER_ARENA_H
+#define BOOMER_ARENA_H
+
+#include "types.h"
+#include <stddef.h>
+
+// Bump allocator for data that lives and dies together (a loaded map).
+// Memory comes from a chain of large blocks and is only given back all at
+// once by Arena_Release. A zeroed Arena is ready to use.
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock* head;   // Block small allocations come from
+    size_t block_size;  // Minimum size of new blocks, 0 = ARENA_DEFAULT_BLOCK
+    size_t reserved;    // Total bytes in all blocks
+} Arena;
+
+#define ARENA_DEFAULT_BLOCK (64 * 1024)
+#define ARENA_ALIGN 16
+
+// Make sure the next `size` bytes of allocations come from one block, so
+// data allocated together is contiguous. Returns false if out of memory.
+bool Arena_Reserve(Arena* arena, size_t size);
+
+// ARENA_ALIGN aligned, uninitialized. NULL if out of memory.
+void* Arena_Alloc(Arena* arena, size_t size);
+
+// Like Arena_Alloc, but zero filled
+void* Arena_AllocZero(Arena* arena, size_t size);
+
+// Free every block. The arena can be used again afterwards.
+void Arena_Release(Arena* arena);
+
+#endif // BOOMER_ARENA_H
@@ -0,0 +1,266 @@
+#include "cache.h"
+#include "fs.h"
+#include "jobs.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_MIN_BUCKETS 64
+
+typedef struct CacheEntry CacheEntry;
+struct CacheEntry {
+    char* path;
+    u32 hash;
+    void* data;             // From FS_ReadFile
+    size_t size;
+    u32 refs;
+    CacheEntry* next_path;  // Bucket chains, by path and by data pointer
+    CacheEntry* next_data;
+    CacheEntry* lru_prev;   // Idle list, only while refs == 0
+    CacheEntry* lru_next;
+};
+
+static JobMutex g_lock = JOB_MUTEX_INIT;
+static CacheEntry** g_by_path = NULL;
+static CacheEntry** g_by_data = NULL;
+static u32 g_bucket_mask = 0;
+static CacheEntry* g_lru_head = NULL;   // Least recently used idle entry
+static CacheEntry* g_lru_tail = NULL;
+static size_t g_idle_bytes = 0;
+static CacheStats g_stats = { .budget = CACHE_DEFAULT_BUDGET };
+
+static u32 HashPath(const char* path) {
+    u32 h = 2166136261u; // FNV-1a
+    for (const u8* p = (const u8*)path; *p; ++p) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static u32 HashData(const void* data) {
+    u64 p = (u64)(uintptr_t)data;
+    return (u32)((p >> 4) * 2654435761u) ^ (u32)(p >> 32);
+}
+
+static CacheEntry* FindPath(const char* path, u32 hash) {
+    if (!g_by_path) return NULL;
+    for (CacheEntry* e = g_by_path[hash & g_bucket_mask]; e; e = e->next_path) {
+        if (e->hash == hash && strcmp(e->path, path) == 0) return e;
+    }
+    return NULL;
+}
+
+static CacheEntry** FindData(const void* data) {
+    if (!g_by_data) return NULL;
+    for (CacheEntry** link = &g_by_data[HashData(data) & g_bucket_mask]; *link; link = &(*link)->next_data) {
+        if ((*link)->data == data) return link;
+    }
+    return NULL;
+}
+
+// Keep about one entry per bucket. Failure just leaves longer chains.
+static void GrowBuckets(void) {
+    u32 count = g_bucket_mask ? (g_bucket_mask + 1) * 2 : CACHE_MIN_BUCKETS;
+    CacheEntry** by_path = (CacheEntry**)calloc(count, sizeof(CacheEntry*));
+    CacheEntry** by_data = (CacheEntry**)calloc(count, sizeof(CacheEntry*));
+    if (!by_path || !by_data) {
+        free(by_path);
+        free(by_data);
+        return;
+    }
+
+    u32 mask = count - 1;
+    for (u32 b = 0; g_by_path && b <= g_bucket_mask; ++b) {
+        CacheEntry* e = g_by_path[b];
+        while (e) {
+            CacheEntry* next = e->next_path;
+            e->next_path = by_path[e->hash & mask];
+            by_path[e->hash & mask] = e;
+            u32 d = HashData(e->data) & mask;
+            e->next_data = by_data[d];
+            by_data[d] = e;
+            e = next;
+        }
+    }
+
+    free(g_by_path);
+    free(g_by_data);
+    g_by_path = by_path;
+    g_by_data = by_data;
+    g_bucket_mask = mask;
+}
+
+static void UnlinkIdle(CacheEntry* e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+    else g_lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+    else g_lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = NULL;
+    g_idle_bytes -= e->size;
+}
+
+static void PushIdle(CacheEntry* e) {
+    e->lru_prev = g_lru_tail;
+    e->lru_next = NULL;
+    if (g_lru_tail) g_lru_tail->lru_next = e;
+    else g_lru_head = e;
+    g_lru_tail = e;
+    g_idle_bytes += e->size;
+}
+
+static void FreeEntry(CacheEntry* e) {
+    CacheEntry** link = &g_by_path[e->hash & g_bucket_mask];
+    while (*link != e) link = &(*link)->next_path;
+    *link = e->next_path;
+    link = FindData(e->data);
+    *link = e->next_data;
+
+    g_stats.bytes -= e->size;
+    g_stats.entries--;
+    FS_FreeFile(e->data);
+    free(e->path);
+    free(e);
+}
+
+// Only idle entries count against the budget; held ones cannot be freed.
+// A budget of 0 frees every idle entry, empty files included.
+static void Evict(size_t budget) {
+    while (g_lru_head && (g_idle_bytes > budget || budget == 0)) {
+        CacheEntry* e = g_lru_head;
+        UnlinkIdle(e);
+        FreeEntry(e);
+        g_stats.evictions++;
+    }
+}
+
+void Cache_SetBudget(size_t bytes) {
+    Jobs_Lock(&g_lock);
+    g_stats.budget = bytes;
+    Evict(bytes);
+    Jobs_Unlock(&g_lock);
+}
+
+// Take a reference to a cached entry; the caller holds g_lock
+static const void* Acquire(CacheEntry* e, size_t* out_size) {
+    if (e->refs++ == 0) UnlinkIdle(e);
+    if (out_size) *out_size = e->size;
+    return e->data;
+}
+
+const void* Cache_ReadFile(const char* path, size_t* out_size) {
+    u32 hash = HashPath(path);
+
+    Jobs_Lock(&g_lock);
+    CacheEntry* e = FindPath(path, hash);
+    if (e) {
+        g_stats.hits++;
+        const void* data = Acquire(e, out_size);
+        Jobs_Unlock(&g_lock);
+        return data;
+    }
+    g_stats.misses++;
+    Jobs_Unlock(&g_lock);
+
+    // Read without the lock so other threads are not held up behind the inflate
+    size_t size;
+    void* data = FS_ReadFile(path, &size);
+    if (!data) return NULL;
+
+    e = (CacheEntry*)calloc(1, sizeof(CacheEntry));
+    char* key = strdup(path);
+    if (!e || !key) {
+        free(e);
+        free(key);
+        printf("Cache: Out of memory caching '%s'\n", path);
+        FS_FreeFile(data);
+        return NULL;
+    }
+
+    Jobs_Lock(&g_lock);
+    CacheEntry* raced = FindPath(path, hash);
+    if (raced) {
+        // Another thread read it in the meantime
+        const void* shared = Acquire(raced, out_size);
+        Jobs_Unlock(&g_lock);
+        FS_FreeFile(data);
+        free(key);
+        free(e);
+        return shared;
+    }
+
+    if (g_stats.entries >= g_bucket_mask) GrowBuckets();
+    if (!g_by_path) {
+        Jobs_Unlock(&g_lock);
+        printf("Cache: Out of memory caching '%s'\n", path);
+        FS_FreeFile(data);
+        free(key);
+        free(e);
+        return NULL;
+    }
+
+    e->path = key;
+    e->hash = hash;
+    e->data = data;
+    e->size = size;
+    e->refs = 1;
+    e->next_path = g_by_path[hash & g_bucket_mask];
+    g_by_path[hash & g_bucket_mask] = e;
+    u32 d = HashData(data) & g_bucket_mask;
+    e->next_data = g_by_data[d];
+    g_by_data[d] = e;
+    g_stats.bytes += size;
+    g_stats.entries++;
+    Jobs_Unlock(&g_lock);
+
+    if (out_size) *out_size = size;
+    return data;
+}
+
+void Cache_ReleaseFile(const void* data) {
+    if (!data) return;
+
+    Jobs_Lock(&g_lock);
+    CacheEntry** link = FindData(data);
+    if (!link || (*link)->refs == 0) {
+        Jobs_Unlock(&g_lock);
+        printf("Cache: Released data that is not held\n");
+        return;
+    }
+
+    CacheEntry* e = *link;
+    if (--e->refs == 0) {
+        PushIdle(e);
+        Evict(g_stats.budget);
+    }
+    Jobs_Unlock(&g_lock);
+}
+
+void Cache_Clear(void) {
+    Jobs_Lock(&g_lock);
+    Evict(0);
+    Jobs_Unlock(&g_lock);
+}
+
+void Cache_Shutdown(void) {
+    Jobs_Lock(&g_lock);
+    Evict(0);
+    if (g_stats.entries > 0) {
+        printf("Cache: %u files still held at shutdown\n", g_stats.entries);
+        for (u32 b = 0; b <= g_bucket_mask; ++b) {
+            while (g_by_path[b]) FreeEntry(g_by_path[b]);
+        }
+    }
+    free(g_by_path);
+    free(g_by_data);
+    g_by_path = g_by_data = NULL;
+    g_bucket_mask = 0;
+    Jobs_Unlock(&g_lock);
+}
+
+void Cache_GetStats(CacheStats* out) {
+    Jobs_Lock(&g_lock);
+    *out = g_stats;
+    Jobs_Unlock(&g_lock);
+}
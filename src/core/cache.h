@@ -0,0 +1,43 @@
+#ifndef BOOMER_CACHE_H
+#define BOOMER_CACHE_H
+
+#include "types.h"
+#include <stddef.h>
+
+// Files read through FS_ReadFile, kept in memory by path so reading one again
+// is a table lookup instead of another read (and inflate, for a pak). Entries
+// are refcounted. Once nothing holds an entry it stays cached until the idle
+// entries go over the budget, least recently used first. Held entries are
+// never freed, so the cache can run over budget while they are in use.
+// Safe on any thread.
+
+#define CACHE_DEFAULT_BUDGET (8 * 1024 * 1024)
+
+typedef struct {
+    u64 hits;
+    u64 misses;         // Including reads of files that do not exist
+    u64 evictions;
+    size_t bytes;       // File data held, in use or idle
+    size_t budget;
+    u32 entries;
+} CacheStats;
+
+// Bytes of file data to keep. Lowering it evicts right away; 0 keeps only
+// entries that are in use.
+void Cache_SetBudget(size_t bytes);
+
+// Like FS_ReadFile, NUL terminated, but shared: the data must not be written
+// and is given back with Cache_ReleaseFile. Paths are used as they are, so
+// "a/./b.js" and "a/b.js" are cached twice.
+const void* Cache_ReadFile(const char* path, size_t* out_size);
+void Cache_ReleaseFile(const void* data);
+
+// Free every idle entry, e.g. after the files on disk changed
+void Cache_Clear(void);
+
+// Free everything, before FS_Shutdown
+void Cache_Shutdown(void);
+
+void Cache_GetStats(CacheStats* out);
+
+#endif // BOOMER_CACHE_H
@@ -0,0 +1,32 @@
+#include "clock.h"
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten.h>
+
+f64 Clock_Now(void) {
+    return emscripten_get_now() * 0.001;
+}
+
+#elif defined(_WIN32)
+// Declared by hand: windows.h clashes with raylib.h (pulled in by types.h)
+__declspec(dllimport) int __stdcall QueryPerformanceCounter(i64* count);
+__declspec(dllimport) int __stdcall QueryPerformanceFrequency(i64* freq);
+
+f64 Clock_Now(void) {
+    static i64 freq = 0;
+    if (freq == 0) QueryPerformanceFrequency(&freq);
+    i64 now;
+    QueryPerformanceCounter(&now);
+    return (f64)now / (f64)freq;
+}
+
+#else
+#include <time.h>
+
+f64 Clock_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef BOOMER_CLOCK_H
+#define BOOMER_CLOCK_H
+
+#include "types.h"
+
+// Monotonic time in seconds since an arbitrary start point.
+// Works without a window, unlike Raylib's GetTime().
+f64 Clock_Now(void);
+
+#endif // BOOMER_CLOCK_H
@@ -11,6 +11,13 @@ static GameConfig g_config = {
     .logical_height = 180,
     .window_scale = 3,
     .fullscreen = false,
+    .headless = false,
+    .render_threads = 1,
+    .dynamic_resolution = false,
+    .dynres_target_ms = 1000.0f / 60.0f,
+    .dynres_min_scale = 0.5f,
+    .dynres_max_scale = 1.0f,
+    .resource_cache_mb = 8,
     .console_bg_color = 0x000000AA,
     .console_text_color = 0xFFFFFFFF,
     .console_font_path = "fonts/unscii-8-thin.ttf",
@@ -70,6 +77,41 @@ static void LoadConfigObj(JSContext* ctx, JSValue obj) {
     }
     JS_FreeValue(ctx, full);
     
+    JSValue headless = JS_GetPropertyStr(ctx, obj, "headless");
+    if (JS_IsBool(headless)) {
+        g_config.headless = JS_ToBool(ctx, headless);
+    }
+    JS_FreeValue(ctx, headless);
+    
+    JSValue threads = JS_GetPropertyStr(ctx, obj, "render_threads");
+    if (JS_IsNumber(threads)) {
+        int t;
+        if (JS_ToInt32(ctx, &t, threads) == 0 && t >= 0) g_config.render_threads = t;
+    }
+    JS_FreeValue(ctx, threads);
+    
+    JSValue dynres = JS_GetPropertyStr(ctx, obj, "dynamic_resolution");
+    if (JS_IsBool(dynres)) {
+        g_config.dynamic_resolution = JS_ToBool(ctx, dynres);
+    }
+    JS_FreeValue(ctx, dynres);
+    
+    const char* dynres_keys[3] = { "dynamic_resolution_target_ms", "dynamic_resolution_min", "dynamic_resolution_max" };
+    f32* dynres_values[3] = { &g_config.dynres_target_ms, &g_config.dynres_min_scale, &g_config.dynres_max_scale };
+    for (int i = 0; i < 3; ++i) {
+        JSValue v = JS_GetPropertyStr(ctx, obj, dynres_keys[i]);
+        double d;
+        if (JS_IsNumber(v) && JS_ToFloat64(ctx, &d, v) == 0 && d > 0) *dynres_values[i] = (f32)d;
+        JS_FreeValue(ctx, v);
+    }
+    
+    JSValue cache_mb = JS_GetPropertyStr(ctx, obj, "resource_cache_mb");
+    if (JS_IsNumber(cache_mb)) {
+        int mb;
+        if (JS_ToInt32(ctx, &mb, cache_mb) == 0 && mb >= 0) g_config.resource_cache_mb = mb;
+    }
+    JS_FreeValue(ctx, cache_mb);
+    
     // Console
     JSValue bg = JS_GetPropertyStr(ctx, obj, "console_background");
     if (JS_IsString(bg)) {
@@ -184,3 +226,7 @@ bool Config_Load() {
 const GameConfig* Config_Get(void) {
     return &g_config;
 }
+
+GameConfig* Config_Edit(void) {
+    return &g_config;
+}
@@ -9,6 +9,19 @@ typedef struct {
     int logical_height;
     int window_scale;
     bool fullscreen;
+    bool headless;      // No window, see Video_SetBackend (also --headless)
+    
+    // Renderer
+    int render_threads; // 0 = one per core, 1 = single-threaded
+    
+    // Dynamic resolution: render below logical resolution to hold a frame time
+    bool dynamic_resolution;
+    f32 dynres_target_ms;   // CPU time per frame to stay under
+    f32 dynres_min_scale;   // Render size range, as a fraction of logical size
+    f32 dynres_max_scale;
+    
+    // Megabytes of script and data files kept in memory after use, see cache.h
+    int resource_cache_mb;
     
     // Console Style
     u32 console_bg_color;   // 0xRRGGBBAA
@@ -25,4 +38,8 @@ bool Config_Load();
 // Get global config
 const GameConfig* Config_Get(void);
 
+// Writable config, for command-line overrides before the systems that read it
+// are initialized
+GameConfig* Config_Edit(void);
+
 #endif // BOOMER_CONFIG_H
@@ -1,19 +1,64 @@
 #include "fs.h"
+#include "jobs.h"
 #include "miniz.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+// Web builds keep files in memory already and Windows has no mmap;
+// FS_MapFile copies there
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define FS_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 #endif
 
+#define FS_PATH_MAX 512
+#define FS_MAX_DEPTH 32 // Directory levels indexed below the mount
+#define ZIP_LOCAL_HEADER_SIZE 30 // Fixed part of a zip local file header
+
 static mz_zip_archive g_archive;
 static bool g_initialized = false;
 static bool g_is_directory = false;
 static char g_base_path[256];
 
+// miniz reads the archive through one FILE, so reads from the map loader
+// thread and the main thread take turns
+static JobMutex g_archive_lock = JOB_MUTEX_INIT;
+
+// The whole archive mapped read-only, so stored entries can be handed out
+// in place. NULL if it could not be mapped.
+static const u8* g_archive_map = NULL;
+static size_t g_archive_map_size = 0;
+
+// Every file of the mount by normalized path, built once in FS_Init.
+// Lookups, misses included, then never touch the disk or the archive.
+// Read-only after the mount, so any thread may use it.
+typedef struct {
+    char* path;
+    u32 hash;
+    u32 archive_index;  // Zip mounts
+    size_t size;        // Uncompressed
+    u64 data_offset;    // Stored zip entries: data in g_archive_map, 0 otherwise
+} FileEntry;
+
+static FileEntry* g_files = NULL;
+static u32 g_file_count = 0;
+static u32 g_file_capacity = 0;
+static u32* g_file_slots = NULL; // Open addressing: entry index + 1, 0 if empty
+static u32 g_file_mask = 0;
+static bool g_indexed = false;   // False if the mount could not be listed
+
 // User Data State
 static char g_user_data_path[256] = {0};
 static bool g_user_data_init = false;
@@ -26,6 +71,227 @@ static void EnsureDirectory(const char* path) {
 #endif
 }
 
+// --- File Index ---
+
+// Canonical form of a path inside the mount: '/' separated, no leading or
+// repeated slashes, "." and ".." resolved. False if it is too long or
+// climbs out of the mount.
+static bool NormalizePath(const char* path, char* out, size_t out_size) {
+    size_t len = 0;
+    const char* p = path;
+    while (*p) {
+        while (*p == '/' || *p == '\\') p++;
+        const char* seg = p;
+        while (*p && *p != '/' && *p != '\\') p++;
+        size_t seg_len = (size_t)(p - seg);
+        
+        if (seg_len == 0 || (seg_len == 1 && seg[0] == '.')) continue;
+        if (seg_len == 2 && seg[0] == '.' && seg[1] == '.') {
+            if (len == 0) return false;
+            while (len > 0 && out[len - 1] != '/') len--;
+            if (len > 0) len--; // The slash itself
+            continue;
+        }
+        
+        if (len + (len ? 1 : 0) + seg_len + 1 > out_size) return false;
+        if (len) out[len++] = '/';
+        memcpy(out + len, seg, seg_len);
+        len += seg_len;
+    }
+    out[len] = '\0';
+    return len > 0;
+}
+
+static u32 HashPath(const char* path) {
+    u32 h = 2166136261u; // FNV-1a
+    for (const u8* p = (const u8*)path; *p; ++p) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void FreeIndex(void) {
+    for (u32 i = 0; i < g_file_count; ++i) free(g_files[i].path);
+    free(g_files);
+    free(g_file_slots);
+    g_files = NULL;
+    g_file_slots = NULL;
+    g_file_count = g_file_capacity = g_file_mask = 0;
+    g_indexed = false;
+}
+
+static void InsertSlot(u32 entry) {
+    u32 i = g_files[entry].hash & g_file_mask;
+    while (g_file_slots[i] != 0) i = (i + 1) & g_file_mask;
+    g_file_slots[i] = entry + 1;
+}
+
+static const FileEntry* FindEntry(const char* normalized) {
+    if (!g_file_slots) return NULL;
+    
+    u32 h = HashPath(normalized);
+    for (u32 i = h & g_file_mask;; i = (i + 1) & g_file_mask) {
+        u32 slot = g_file_slots[i];
+        if (slot == 0) return NULL;
+        const FileEntry* e = &g_files[slot - 1];
+        if (e->hash == h && strcmp(e->path, normalized) == 0) return e;
+    }
+}
+
+// Add a file, keeping the table at most half full. Duplicates keep the first.
+static bool AddEntry(const char* path, u32 archive_index, size_t size, u64 data_offset) {
+    char normalized[FS_PATH_MAX];
+    if (!NormalizePath(path, normalized, sizeof(normalized))) return true; // Unreachable by any lookup
+    if (FindEntry(normalized)) return true;
+    
+    if (g_file_count == g_file_capacity) {
+        u32 capacity = g_file_capacity ? g_file_capacity * 2 : 256;
+        FileEntry* files = (FileEntry*)realloc(g_files, sizeof(FileEntry) * capacity);
+        if (!files) return false;
+        g_files = files;
+        
+        u32* slots = (u32*)calloc((size_t)capacity * 2, sizeof(u32));
+        if (!slots) return false;
+        free(g_file_slots);
+        g_file_slots = slots;
+        g_file_mask = capacity * 2 - 1;
+        g_file_capacity = capacity;
+        for (u32 i = 0; i < g_file_count; ++i) InsertSlot(i);
+    }
+    
+    FileEntry* e = &g_files[g_file_count];
+    e->path = strdup(normalized);
+    if (!e->path) return false;
+    e->hash = HashPath(normalized);
+    e->archive_index = archive_index;
+    e->size = size;
+    e->data_offset = data_offset;
+    InsertSlot(g_file_count++);
+    return true;
+}
+
+#ifndef _WIN32
+// Index every regular file below dir; rel is its path inside the mount
+static bool IndexDirectory(const char* dir, const char* rel, int depth) {
+    if (depth > FS_MAX_DEPTH) return true;
+    
+    DIR* d = opendir(dir);
+    if (!d) return depth > 0; // Unreadable subdirectories are just left out
+    
+    bool ok = true;
+    struct dirent* ent;
+    while (ok && (ent = readdir(d)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+        
+        char full_path[FS_PATH_MAX];
+        char rel_path[FS_PATH_MAX];
+        if (snprintf(full_path, sizeof(full_path), "%s/%s", dir, ent->d_name) >= (int)sizeof(full_path)) continue;
+        if (snprintf(rel_path, sizeof(rel_path), "%s%s%s", rel, rel[0] ? "/" : "", ent->d_name) >= (int)sizeof(rel_path)) continue;
+        
+        struct stat st;
+        if (stat(full_path, &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) ok = IndexDirectory(full_path, rel_path, depth + 1);
+        else if (S_ISREG(st.st_mode)) ok = AddEntry(rel_path, 0, (size_t)st.st_size, 0);
+    }
+    closedir(d);
+    return ok;
+}
+#endif
+
+static u16 ReadU16(const u8* p) {
+    return (u16)(p[0] | (p[1] << 8));
+}
+
+// Where the data of an uncompressed, unencrypted entry starts in the
+// archive mapping, 0 if it cannot be used in place
+static u64 StoredDataOffset(const mz_zip_archive_file_stat* stat) {
+    if (!g_archive_map || stat->m_method != 0 || (stat->m_bit_flag & 1) ||
+        stat->m_comp_size != stat->m_uncomp_size) return 0;
+    
+    // The local header repeats the name and has its own extra field
+    u64 header = stat->m_local_header_ofs;
+    if (header + ZIP_LOCAL_HEADER_SIZE > g_archive_map_size) return 0;
+    const u8* h = g_archive_map + header;
+    if (h[0] != 'P' || h[1] != 'K' || h[2] != 3 || h[3] != 4) return 0;
+    
+    u64 data = header + ZIP_LOCAL_HEADER_SIZE + ReadU16(h + 26) + ReadU16(h + 28);
+    if (data + stat->m_uncomp_size > g_archive_map_size) return 0;
+    return data;
+}
+
+static bool IndexArchive(void) {
+    mz_uint count = mz_zip_reader_get_num_files(&g_archive);
+    for (mz_uint i = 0; i < count; ++i) {
+        if (mz_zip_reader_is_file_a_directory(&g_archive, i)) continue;
+        
+        mz_zip_archive_file_stat stat;
+        if (!mz_zip_reader_file_stat(&g_archive, i, &stat)) continue;
+        if (!AddEntry(stat.m_filename, i, (size_t)stat.m_uncomp_size, StoredDataOffset(&stat))) return false;
+    }
+    return true;
+}
+
+static void BuildIndex(void) {
+    FreeIndex();
+    
+#ifdef _WIN32
+    g_indexed = !g_is_directory && IndexArchive();
+#else
+    g_indexed = g_is_directory ? IndexDirectory(g_base_path, "", 0) : IndexArchive();
+#endif
+    if (g_indexed) {
+        printf("FS: Indexed %u files\n", g_file_count);
+    } else {
+        FreeIndex(); // Lookups go to the mount directly
+    }
+}
+
+// The index entry for path. found is false if the index proves it does not
+// exist; with no index, NULL and found true mean "ask the mount".
+static const FileEntry* LookupFile(const char* path, char* normalized, bool* found) {
+    if (!NormalizePath(path, normalized, FS_PATH_MAX)) {
+        *found = false;
+        return NULL;
+    }
+    if (!g_indexed) {
+        *found = true;
+        return NULL;
+    }
+    const FileEntry* e = FindEntry(normalized);
+    *found = (e != NULL);
+    return e;
+}
+
+// --- Mount ---
+
+static void MapArchive(const char* archive_path) {
+#ifdef FS_HAS_MMAP
+    int fd = open(archive_path, O_RDONLY);
+    if (fd < 0) return;
+    
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            g_archive_map = (const u8*)p;
+            g_archive_map_size = (size_t)st.st_size;
+        }
+    }
+    close(fd);
+#else
+    (void)archive_path;
+#endif
+}
+
+static void UnmapArchive(void) {
+#ifdef FS_HAS_MMAP
+    if (g_archive_map) munmap((void*)g_archive_map, g_archive_map_size);
+#endif
+    g_archive_map = NULL;
+    g_archive_map_size = 0;
+}
+
 bool FS_Init(const char* archive_path) {
     if (g_initialized) FS_Shutdown();
     
@@ -36,6 +302,7 @@ bool FS_Init(const char* archive_path) {
         strncpy(g_base_path, archive_path, sizeof(g_base_path) - 1);
         g_initialized = true;
         printf("FS: Mounted directory '%s'\n", archive_path);
+        BuildIndex();
         return true;
     }
     
@@ -50,6 +317,8 @@ bool FS_Init(const char* archive_path) {
     
     g_initialized = true;
     printf("FS: Mounted archive '%s'\n", archive_path);
+    MapArchive(archive_path);
+    BuildIndex();
     return true;
 }
 
@@ -58,17 +327,62 @@ void FS_Shutdown(void) {
         if (!g_is_directory) {
             mz_zip_reader_end(&g_archive);
         }
+        FreeIndex();
+        UnmapArchive();
         g_initialized = false;
     }
 }
 
+static void* ReadArchiveFile(const char* path, const FileEntry* entry, size_t* out_size) {
+    mz_uint file_index;
+    size_t size;
+    if (entry) {
+        file_index = entry->archive_index;
+        size = entry->size;
+    } else {
+        int located = mz_zip_reader_locate_file(&g_archive, path, NULL, 0);
+        if (located < 0) {
+            printf("FS: File '%s' not found in archive.\n", path);
+            return NULL;
+        }
+        
+        mz_zip_archive_file_stat stat;
+        if (!mz_zip_reader_file_stat(&g_archive, (mz_uint)located, &stat)) {
+            return NULL;
+        }
+        file_index = (mz_uint)located;
+        size = (size_t)stat.m_uncomp_size;
+    }
+    
+    void* p = malloc(size + 1);
+    if (!p) return NULL;
+    
+    if (!mz_zip_reader_extract_to_mem(&g_archive, file_index, p, size, 0)) {
+        free(p);
+        return NULL;
+    }
+    
+    ((char*)p)[size] = 0; // Null Check
+    
+    if (out_size) *out_size = size;
+    return p;
+}
+
 void* FS_ReadFile(const char* path, size_t* out_size) {
     if (!g_initialized) return NULL;
     
+    char normalized[FS_PATH_MAX];
+    bool found;
+    const FileEntry* entry = LookupFile(path, normalized, &found);
+    if (!found) {
+        printf("FS: File '%s' not found.\n", path);
+        return NULL;
+    }
+    
     if (g_is_directory) {
         // Read from OS file system
-        char full_path[512];
-        snprintf(full_path, sizeof(full_path), "%s/%s", g_base_path, path);
+        char full_path[FS_PATH_MAX + 256];
+        snprintf(full_path, sizeof(full_path), "%s/%s", g_base_path, normalized);
         
         FILE* f = fopen(full_path, "rb");
         if (!f) {
@@ -76,13 +390,12 @@ void* FS_ReadFile(const char* path, size_t* out_size) {
             return NULL;
         }
         
-        fseek(f, 0, SEEK_END);
-        long length = ftell(f);
-        fseek(f, 0, SEEK_SET);
-        
-        if (length < 0) { fclose(f); return NULL; }
+        // Size from the open file rather than the index, which may be
+        // stale if the file was edited since the mount
+        struct stat st;
+        if (fstat(fileno(f), &st) != 0) { fclose(f); return NULL; }
         
-        size_t size = (size_t)length;
+        size_t size = (size_t)st.st_size;
         void* p = malloc(size + 1);
         if (!p) { fclose(f); return NULL; }
         
@@ -99,35 +412,123 @@ void* FS_ReadFile(const char* path, size_t* out_size) {
         return p;
 
     } else {
-        // Read from Zip
-        int file_index = mz_zip_reader_locate_file(&g_archive, path, NULL, 0);
-        if (file_index < 0) {
-            printf("FS: File '%s' not found in archive.\n", path);
-            return NULL;
-        }
-        
-        mz_zip_archive_file_stat stat;
-        if (!mz_zip_reader_file_stat(&g_archive, file_index, &stat)) {
-            return NULL;
-        }
-        
-        size_t size = (size_t)stat.m_uncomp_size;
-        
-        void* p = malloc(size + 1);
-        if (!p) return NULL;
-        
-        if (!mz_zip_reader_extract_to_mem(&g_archive, file_index, p, size, 0)) {
-            free(p);
-            return NULL;
-        }
-        
-        ((char*)p)[size] = 0; // Null Check
-        
-        if (out_size) *out_size = size;
+        Jobs_Lock(&g_archive_lock);
+        void* p = ReadArchiveFile(normalized, entry, out_size);
+        Jobs_Unlock(&g_archive_lock);
         return p;
     }
 }
 
+bool FS_Exists(const char* path) {
+    return FS_GetFileSize(path, NULL);
+}
+
+bool FS_GetFileSize(const char* path, size_t* out_size) {
+    if (!g_initialized) return false;
+    
+    char normalized[FS_PATH_MAX];
+    bool found;
+    const FileEntry* entry = LookupFile(path, normalized, &found);
+    if (!found) return false;
+    if (entry) {
+        if (out_size) *out_size = entry->size;
+        return true;
+    }
+    
+    // No index: ask the mount
+    if (g_is_directory) {
+        char full_path[FS_PATH_MAX + 256];
+        snprintf(full_path, sizeof(full_path), "%s/%s", g_base_path, normalized);
+        struct stat st;
+        if (stat(full_path, &st) != 0 || !S_ISREG(st.st_mode)) return false;
+        if (out_size) *out_size = (size_t)st.st_size;
+        return true;
+    }
+    
+    Jobs_Lock(&g_archive_lock);
+    int located = mz_zip_reader_locate_file(&g_archive, normalized, NULL, 0);
+    mz_zip_archive_file_stat stat;
+    bool ok = located >= 0 && mz_zip_reader_file_stat(&g_archive, (mz_uint)located, &stat);
+    Jobs_Unlock(&g_archive_lock);
+    if (ok && out_size) *out_size = (size_t)stat.m_uncomp_size;
+    return ok;
+}
+
+// Heap copy fallback for FS_MapFile
+static bool CopyFile(const char* path, FSMapping* out) {
+    size_t size = 0;
+    void* data = FS_ReadFile(path, &size);
+    if (!data) return false;
+    
+    out->data = data;
+    out->size = size;
+    out->base = data;
+    out->kind = FS_MAPPING_COPY;
+    return true;
+}
+
+bool FS_MapFile(const char* path, FSMapping* out) {
+    memset(out, 0, sizeof(*out));
+    if (!g_initialized) return false;
+    
+    char normalized[FS_PATH_MAX];
+    bool found;
+    const FileEntry* entry = LookupFile(path, normalized, &found);
+    if (!found) {
+        printf("FS: File '%s' not found.\n", path);
+        return false;
+    }
+    
+    // Stored zip entries are used straight from the archive mapping
+    if (!g_is_directory) {
+        if (entry && entry->data_offset) {
+            out->data = g_archive_map + entry->data_offset;
+            out->size = entry->size;
+            out->kind = FS_MAPPING_ARCHIVE;
+            return true;
+        }
+        return CopyFile(normalized, out);
+    }
+    
+#ifdef FS_HAS_MMAP
+    char full_path[FS_PATH_MAX + 256];
+    snprintf(full_path, sizeof(full_path), "%s/%s", g_base_path, normalized);
+    
+    int fd = open(full_path, O_RDONLY);
+    if (fd < 0) {
+        printf("FS: File '%s' not found in directory.\n", full_path);
+        return false;
+    }
+    
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    
+    if (p != MAP_FAILED) {
+        out->data = p;
+        out->size = (size_t)st.st_size;
+        out->base = p;
+        out->kind = FS_MAPPING_MMAP;
+        return true;
+    }
+#endif
+    return CopyFile(normalized, out); // Empty files cannot be mapped
+}
+
+void FS_UnmapFile(FSMapping* file) {
+    switch (file->kind) {
+#ifdef FS_HAS_MMAP
+    case FS_MAPPING_MMAP: munmap(file->base, file->size); break;
+#endif
+    case FS_MAPPING_COPY: FS_FreeFile(file->base); break;
+    default: break; // Archive mappings live until FS_Shutdown
+    }
+    memset(file, 0, sizeof(*file));
+}
+
 void FS_FreeFile(void* data) {
     if (data) free(data);
 }
@@ -4,7 +4,9 @@
 #include "types.h"
 #include <stddef.h>
 
-// Initialize the File System with a main archive (PAK)
+// Initialize the File System with a main archive (PAK) or a directory.
+// Every file in it is indexed by path here, so files added to a mounted
+// directory later are not seen until the next FS_Init.
 bool FS_Init(const char* archive_path);
 
 // Shutdown and close archive
@@ -19,6 +21,32 @@ void* FS_ReadFile(const char* path, size_t* out_size);
 // Free file memory
 void FS_FreeFile(void* data);
 
+// Read-only view of a whole file from FS_MapFile. Unlike FS_ReadFile the
+// data is not NUL terminated, and writing to it may crash.
+typedef enum {
+    FS_MAPPING_NONE,
+    FS_MAPPING_MMAP,     // The file mapped from a mounted directory
+    FS_MAPPING_ARCHIVE,  // A stored (uncompressed) entry in the mapped archive
+    FS_MAPPING_COPY,     // Compressed entries, or no mmap on this platform
+} FSMappingKind;
+
+typedef struct {
+    const void* data;
+    size_t size;
+    void* base;          // What FS_UnmapFile releases
+    FSMappingKind kind;
+} FSMapping;
+
+// Map a file without copying it where possible. Safe on any thread.
+// Release with FS_UnmapFile, before FS_Shutdown.
+bool FS_MapFile(const char* path, FSMapping* out);
+void FS_UnmapFile(FSMapping* file);
+
+// Lookups in the index of the mount built by FS_Init, without reading.
+// Paths are normalized first, so "scripts/./a/../b.js" finds "scripts/b.js".
+bool FS_Exists(const char* path);
+bool FS_GetFileSize(const char* path, size_t* out_size);
+
 // User Data Persistence
 bool FS_InitUserData(const char* mount_point);
 bool FS_WriteUserData(const char* filename, const void* data, size_t size);
@@ -0,0 +1,272 @@
+#include "jobs.h"
+#include "profiler.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_JOB_THREADS 64
+
+#ifndef JOBS_SERIAL
+#include <stdatomic.h>
+#include <unistd.h>
+
+static pthread_t g_workers[MAX_JOB_THREADS];
+static int g_worker_count = 0; // Threads besides the caller
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t g_done_cond = PTHREAD_COND_INITIALIZER;
+
+// Current job (guarded by g_lock, read by workers after a generation bump)
+static JobFunc g_func = NULL;
+static void* g_user = NULL;
+static int g_count = 0;
+static atomic_int g_next_index;
+static int g_pending = 0;    // Workers that have not finished the current generation
+static u32 g_generation = 0;
+static bool g_quit = false;
+
+static void RunIndices(void) {
+    int i;
+    while ((i = atomic_fetch_add(&g_next_index, 1)) < g_count) {
+        g_func(g_user, i);
+    }
+}
+
+static void* WorkerMain(void* arg) {
+    char name[32];
+    snprintf(name, sizeof(name), "Worker %d", (int)(intptr_t)arg + 1);
+    Profile_SetThreadName(name);
+    
+    u32 seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&g_lock);
+        while (!g_quit && g_generation == seen) {
+            pthread_cond_wait(&g_work_cond, &g_lock);
+        }
+        if (g_quit) {
+            pthread_mutex_unlock(&g_lock);
+            break;
+        }
+        seen = g_generation;
+        pthread_mutex_unlock(&g_lock);
+
+        RunIndices();
+
+        pthread_mutex_lock(&g_lock);
+        if (--g_pending == 0) pthread_cond_signal(&g_done_cond);
+        pthread_mutex_unlock(&g_lock);
+    }
+    return NULL;
+}
+
+// Tasks run one at a time on a single loader thread that lives as long as
+// the pool, so starting a task costs no thread (or profiler slot) of its own
+struct JobTask {
+    TaskFunc func;
+    void* user;
+    JobTask* next;
+    atomic_bool done;
+};
+
+static pthread_t g_task_thread;
+static bool g_task_thread_running = false;
+static pthread_mutex_t g_task_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_task_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t g_task_done_cond = PTHREAD_COND_INITIALIZER;
+static JobTask* g_task_head = NULL; // Queued tasks, oldest first (guarded by g_task_lock)
+static JobTask* g_task_tail = NULL;
+static bool g_task_quit = false;
+
+static void* TaskMain(void* arg) {
+    (void)arg;
+    Profile_SetThreadName("Loader");
+
+    for (;;) {
+        pthread_mutex_lock(&g_task_lock);
+        while (!g_task_quit && !g_task_head) {
+            pthread_cond_wait(&g_task_cond, &g_task_lock);
+        }
+        // Queued tasks still run on quit, so nobody waits on them forever
+        JobTask* task = g_task_head;
+        if (!task) {
+            pthread_mutex_unlock(&g_task_lock);
+            break;
+        }
+        g_task_head = task->next;
+        if (!g_task_head) g_task_tail = NULL;
+        pthread_mutex_unlock(&g_task_lock);
+
+        task->func(task->user);
+
+        pthread_mutex_lock(&g_task_lock);
+        atomic_store(&task->done, true);
+        pthread_cond_broadcast(&g_task_done_cond);
+        pthread_mutex_unlock(&g_task_lock);
+    }
+    return NULL;
+}
+
+static void StartTaskThread(void) {
+    g_task_quit = false;
+    g_task_thread_running = pthread_create(&g_task_thread, NULL, TaskMain, NULL) == 0;
+    if (!g_task_thread_running) printf("Jobs: Failed to start the loader thread.\n");
+}
+
+static void StopTaskThread(void) {
+    if (!g_task_thread_running) return;
+
+    pthread_mutex_lock(&g_task_lock);
+    g_task_quit = true;
+    pthread_cond_signal(&g_task_cond);
+    pthread_mutex_unlock(&g_task_lock);
+
+    pthread_join(g_task_thread, NULL);
+    g_task_thread_running = false;
+}
+
+bool Jobs_Init(int thread_count) {
+    if (g_worker_count > 0 || g_task_thread_running) Jobs_Shutdown();
+
+    if (thread_count <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (cores > 0) ? (int)cores : 1;
+    }
+    if (thread_count > MAX_JOB_THREADS) thread_count = MAX_JOB_THREADS;
+
+    g_quit = false;
+    for (int i = 0; i < thread_count - 1; ++i) {
+        if (pthread_create(&g_workers[i], NULL, WorkerMain, (void*)(intptr_t)i) != 0) {
+            printf("Jobs: Failed to start worker %d, continuing with %d.\n", i, g_worker_count);
+            break;
+        }
+        g_worker_count++;
+    }
+
+    StartTaskThread();
+
+    printf("Jobs: %d thread(s)\n", g_worker_count + 1);
+    return true;
+}
+
+void Jobs_Shutdown(void) {
+    pthread_mutex_lock(&g_lock);
+    g_quit = true;
+    pthread_cond_broadcast(&g_work_cond);
+    pthread_mutex_unlock(&g_lock);
+
+    for (int i = 0; i < g_worker_count; ++i) {
+        pthread_join(g_workers[i], NULL);
+    }
+    g_worker_count = 0;
+
+    StopTaskThread();
+}
+
+int Jobs_GetThreadCount(void) {
+    return g_worker_count + 1;
+}
+
+void Jobs_ParallelFor(int count, JobFunc func, void* user) {
+    if (count <= 0) return;
+
+    if (g_worker_count == 0 || count == 1) {
+        for (int i = 0; i < count; ++i) func(user, i);
+        return;
+    }
+
+    pthread_mutex_lock(&g_lock);
+    g_func = func;
+    g_user = user;
+    g_count = count;
+    atomic_store(&g_next_index, 0);
+    g_pending = g_worker_count;
+    g_generation++;
+    pthread_cond_broadcast(&g_work_cond);
+    pthread_mutex_unlock(&g_lock);
+
+    RunIndices();
+
+    pthread_mutex_lock(&g_lock);
+    while (g_pending > 0) {
+        pthread_cond_wait(&g_done_cond, &g_lock);
+    }
+    pthread_mutex_unlock(&g_lock);
+}
+
+JobTask* Jobs_StartTask(TaskFunc func, void* user) {
+    if (!g_task_thread_running) {
+        printf("Jobs: No loader thread to run the task.\n");
+        return NULL;
+    }
+
+    JobTask* task = (JobTask*)malloc(sizeof(JobTask));
+    if (!task) return NULL;
+    
+    task->func = func;
+    task->user = user;
+    task->next = NULL;
+    atomic_init(&task->done, false);
+
+    pthread_mutex_lock(&g_task_lock);
+    if (g_task_tail) g_task_tail->next = task;
+    else g_task_head = task;
+    g_task_tail = task;
+    pthread_cond_signal(&g_task_cond);
+    pthread_mutex_unlock(&g_task_lock);
+    return task;
+}
+
+bool Jobs_IsTaskDone(JobTask* task) {
+    return atomic_load(&task->done);
+}
+
+void Jobs_FinishTask(JobTask* task) {
+    pthread_mutex_lock(&g_task_lock);
+    while (!atomic_load(&task->done)) {
+        pthread_cond_wait(&g_task_done_cond, &g_task_lock);
+    }
+    pthread_mutex_unlock(&g_task_lock);
+    free(task);
+}
+
+#else // JOBS_SERIAL
+
+bool Jobs_Init(int thread_count) {
+    if (thread_count > 1) {
+        printf("Jobs: Threads unavailable on this platform, running single-threaded.\n");
+    }
+    return true;
+}
+
+void Jobs_Shutdown(void) {
+}
+
+int Jobs_GetThreadCount(void) {
+    return 1;
+}
+
+void Jobs_ParallelFor(int count, JobFunc func, void* user) {
+    for (int i = 0; i < count; ++i) func(user, i);
+}
+
+struct JobTask {
+    int unused;
+};
+
+JobTask* Jobs_StartTask(TaskFunc func, void* user) {
+    JobTask* task = (JobTask*)malloc(sizeof(JobTask));
+    if (task) func(user);
+    return task;
+}
+
+bool Jobs_IsTaskDone(JobTask* task) {
+    return true;
+}
+
+void Jobs_FinishTask(JobTask* task) {
+    free(task);
+}
+
+#endif // JOBS_SERIAL
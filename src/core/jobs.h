@@ -0,0 +1,60 @@
+#ifndef BOOMER_JOBS_H
+#define BOOMER_JOBS_H
+
+#include "types.h"
+
+// Web builds without -pthread and Windows (no pthreads) run everything on the caller.
+#if defined(_WIN32) || (defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__))
+#define JOBS_SERIAL 1
+#endif
+
+#ifndef JOBS_SERIAL
+#include <pthread.h>
+typedef pthread_mutex_t JobMutex;
+#define JOB_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define Jobs_Lock(m) pthread_mutex_lock(m)
+#define Jobs_Unlock(m) pthread_mutex_unlock(m)
+#else
+typedef int JobMutex;
+#define JOB_MUTEX_INIT 0
+#define Jobs_Lock(m) ((void)(m))
+#define Jobs_Unlock(m) ((void)(m))
+#endif
+
+// Work function for Jobs_ParallelFor. Called once per index in [0, count).
+typedef void (*JobFunc)(void* user, int index);
+
+// Start the worker pool.
+// thread_count is the total number of threads that take part in a parallel
+// job, including the calling thread. 0 picks one per CPU core, 1 disables the
+// pool (everything runs on the caller).
+bool Jobs_Init(int thread_count);
+
+// Stop and join all workers
+void Jobs_Shutdown(void);
+
+// Number of threads that take part in Jobs_ParallelFor (always >= 1)
+int Jobs_GetThreadCount(void);
+
+// Run func(user, i) for every i in [0, count) across the pool.
+// The calling thread takes part and the call returns once every index is done.
+// Not re-entrant: must only be called from the main thread.
+void Jobs_ParallelFor(int count, JobFunc func, void* user);
+
+// Long running work (map loading) off the main thread, so frames keep going
+// meanwhile. Tasks run one at a time, in start order, on a loader thread
+// that Jobs_Init starts. Without thread support the task runs to completion
+// inside Jobs_StartTask.
+typedef struct JobTask JobTask;
+typedef void (*TaskFunc)(void* user);
+
+// NULL if the task could not be started (func has not run)
+JobTask* Jobs_StartTask(TaskFunc func, void* user);
+
+// True once func has returned
+bool Jobs_IsTaskDone(JobTask* task);
+
+// Wait for func to return and free the task
+void Jobs_FinishTask(JobTask* task);
+
+#endif // BOOMER_JOBS_H
@@ -0,0 +1,240 @@
+#include "profiler.h"
+#include "clock.h"
+#include "fs.h"
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROFILE_RING_SIZE 16384 // Zones kept per thread (power of two)
+#define PROFILE_MAX_DEPTH 32    // Deeper zones are timed by their parents only
+#define PROFILE_MAX_THREADS 72  // Main thread + Jobs workers, with room to spare
+
+typedef struct {
+    const char* name;
+    f64 start;
+    f64 end;
+} ProfileZone;
+
+typedef struct {
+    char name[32];
+    int tid;
+    ProfileZone* ring;
+    atomic_uint written;    // Zones ever written; the newest is at (written - 1) % size
+    atomic_int depth;       // Open zones; the ring is only written while > 0
+    atomic_bool dumping;    // Set while Profile_DumpTrace reads the ring
+    const char* open_name[PROFILE_MAX_DEPTH];
+    f64 open_start[PROFILE_MAX_DEPTH]; // < 0 if the zone began while disabled
+} ProfileThread;
+
+static _Atomic(ProfileThread*) g_threads[PROFILE_MAX_THREADS];
+static atomic_int g_thread_count = 0;
+static _Thread_local ProfileThread* t_thread = NULL;
+static bool g_enabled = true;
+static f64 g_origin = 0;
+
+// The calling thread's buffer, created on first use. NULL if out of slots.
+static ProfileThread* GetThread(void) {
+    if (t_thread) return t_thread;
+
+    int tid = atomic_fetch_add(&g_thread_count, 1);
+    if (tid >= PROFILE_MAX_THREADS) return NULL;
+
+    ProfileThread* t = (ProfileThread*)calloc(1, sizeof(ProfileThread));
+    if (!t) return NULL;
+    t->ring = (ProfileZone*)malloc(sizeof(ProfileZone) * PROFILE_RING_SIZE);
+    if (!t->ring) {
+        free(t);
+        return NULL;
+    }
+    t->tid = tid;
+    snprintf(t->name, sizeof(t->name), "Thread %d", tid);
+
+    atomic_store_explicit(&g_threads[tid], t, memory_order_release);
+    t_thread = t;
+    return t;
+}
+
+void Profile_Init(void) {
+    g_origin = Clock_Now();
+    Profile_SetThreadName("Main");
+}
+
+void Profile_Shutdown(void) {
+    int count = atomic_load(&g_thread_count);
+    if (count > PROFILE_MAX_THREADS) count = PROFILE_MAX_THREADS;
+
+    for (int i = 0; i < count; ++i) {
+        ProfileThread* t = atomic_load(&g_threads[i]);
+        if (!t) continue;
+        free(t->ring);
+        free(t);
+        atomic_store(&g_threads[i], NULL);
+    }
+    atomic_store(&g_thread_count, 0);
+    t_thread = NULL; // Only the caller's; other threads are gone
+}
+
+void Profile_SetThreadName(const char* name) {
+    ProfileThread* t = GetThread();
+    if (t) snprintf(t->name, sizeof(t->name), "%s", name);
+}
+
+void Profile_SetEnabled(bool enabled) {
+    g_enabled = enabled;
+}
+
+bool Profile_IsEnabled(void) {
+    return g_enabled;
+}
+
+void Profile_Begin(const char* name) {
+    ProfileThread* t = GetThread();
+    if (!t) return;
+
+    // Count the zone as open before looking at dumping (both sequentially
+    // consistent): either the dump sees it open and skips this thread, or
+    // the zone sees the dump and is not recorded
+    int depth = atomic_fetch_add(&t->depth, 1);
+    if (depth < PROFILE_MAX_DEPTH) {
+        t->open_name[depth] = name;
+        t->open_start[depth] = (g_enabled && !atomic_load(&t->dumping)) ? Clock_Now() : -1.0;
+    }
+}
+
+void Profile_End(void) {
+    ProfileThread* t = t_thread;
+    if (!t) return;
+    int depth = atomic_load_explicit(&t->depth, memory_order_relaxed) - 1;
+    if (depth < 0) return;
+
+    // The zone is written before it is closed, so a dump that sees no open
+    // zones also sees every write
+    if (depth < PROFILE_MAX_DEPTH && t->open_start[depth] >= 0 && g_enabled) {
+        u32 n = atomic_load_explicit(&t->written, memory_order_relaxed);
+        ProfileZone* z = &t->ring[n & (PROFILE_RING_SIZE - 1)];
+        z->name = t->open_name[depth];
+        z->start = t->open_start[depth];
+        z->end = Clock_Now();
+        atomic_store_explicit(&t->written, n + 1, memory_order_release);
+    }
+    atomic_store(&t->depth, depth);
+}
+
+// --- Trace Export ---
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+} TraceBuffer;
+
+static void Append(TraceBuffer* buf, const char* fmt, ...) {
+    if (buf->failed) return;
+
+    for (;;) {
+        va_list args;
+        va_start(args, fmt);
+        int len = vsnprintf(buf->data + buf->size, buf->capacity - buf->size, fmt, args);
+        va_end(args);
+        if (len < 0) {
+            buf->failed = true;
+            return;
+        }
+        if (buf->size + (size_t)len < buf->capacity) {
+            buf->size += (size_t)len;
+            return;
+        }
+
+        size_t capacity = buf->capacity * 2 + (size_t)len;
+        char* data = (char*)realloc(buf->data, capacity);
+        if (!data) {
+            buf->failed = true;
+            return;
+        }
+        buf->data = data;
+        buf->capacity = capacity;
+    }
+}
+
+// s with JSON string escapes, cut short if it does not fit in out
+static const char* EscapeJson(const char* s, char* out, size_t size) {
+    size_t n = 0;
+    for (; *s && n + 7 < size; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            out[n++] = '\\';
+            out[n++] = (char)c;
+        } else if (c < 0x20) {
+            n += (size_t)snprintf(out + n, size - n, "\\u%04x", c);
+        } else {
+            out[n++] = (char)c;
+        }
+    }
+    out[n] = '\0';
+    return out;
+}
+
+bool Profile_DumpTrace(const char* filename) {
+    TraceBuffer buf = { .capacity = 1 << 20 };
+    buf.data = (char*)malloc(buf.capacity);
+    if (!buf.data) return false;
+
+    int count = atomic_load(&g_thread_count);
+    if (count > PROFILE_MAX_THREADS) count = PROFILE_MAX_THREADS;
+
+    u32 zones = 0;
+    int dumped = 0;
+    int busy = 0;
+    bool first = true;
+    char escaped[128];
+    Append(&buf, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (int i = 0; i < count; ++i) {
+        ProfileThread* t = atomic_load_explicit(&g_threads[i], memory_order_acquire);
+        if (!t) continue;
+
+        // The caller cannot write its own ring while it is in here, whatever
+        // zones it has open. Another thread inside a zone (the loader,
+        // mid-load) might, so it is left out. Zones that thread opens from
+        // now on are not recorded until the dump is done.
+        bool self = (t == t_thread);
+        if (!self) {
+            atomic_store(&t->dumping, true);
+            if (atomic_load(&t->depth) > 0) {
+                atomic_store(&t->dumping, false);
+                busy++;
+                continue;
+            }
+        }
+
+        Append(&buf, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+               first ? "" : ",", t->tid, EscapeJson(t->name, escaped, sizeof(escaped)));
+        first = false;
+        dumped++;
+
+        u32 written = atomic_load_explicit(&t->written, memory_order_acquire);
+        u32 oldest = written > PROFILE_RING_SIZE ? written - PROFILE_RING_SIZE : 0;
+        for (u32 n = oldest; n < written; ++n) {
+            const ProfileZone* z = &t->ring[n & (PROFILE_RING_SIZE - 1)];
+            // Complete events, timestamps in microseconds
+            Append(&buf, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                   EscapeJson(z->name, escaped, sizeof(escaped)), t->tid, (z->start - g_origin) * 1e6, (z->end - z->start) * 1e6);
+        }
+        zones += written - oldest;
+        if (!self) atomic_store(&t->dumping, false);
+    }
+    Append(&buf, "\n]}\n");
+
+    bool ok = !buf.failed && FS_WriteUserData(filename, buf.data, buf.size);
+    if (ok) {
+        printf("Profile: Wrote %u zones from %d thread(s) to '%s'", zones, dumped, filename);
+        if (busy) printf(", skipped %d busy thread(s)", busy);
+        printf("\n");
+    } else {
+        printf("Profile: Failed to write trace '%s'\n", filename);
+    }
+    free(buf.data);
+    return ok;
+}
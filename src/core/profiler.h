@@ -0,0 +1,56 @@
+#ifndef BOOMER_PROFILER_H
+#define BOOMER_PROFILER_H
+
+#include "types.h"
+#include <stdbool.h>
+
+// Scoped CPU timing zones.
+// Every thread records finished zones into its own ring buffer, so the last
+// few thousand zones per thread are always available. Profile_DumpTrace
+// writes them as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// Zone names must be string literals (or otherwise outlive the dump).
+// Build with -DBOOMER_PROFILE=0 to compile the zones out.
+#ifndef BOOMER_PROFILE
+#define BOOMER_PROFILE 1
+#endif
+
+// Set the start of the trace timeline and name the calling (main) thread
+void Profile_Init(void);
+
+// Free all thread buffers. Other threads must have stopped recording.
+void Profile_Shutdown(void);
+
+// Name the calling thread in traces
+void Profile_SetThreadName(const char* name);
+
+// Pause/resume recording (on by default)
+void Profile_SetEnabled(bool enabled);
+bool Profile_IsEnabled(void);
+
+// Open and close a zone on the calling thread. Zones nest.
+void Profile_Begin(const char* name);
+void Profile_End(void);
+
+// Write every recorded zone to filename in user data. Zones still open on
+// the calling thread are not written yet. Call it while no parallel job is
+// running; other threads that are inside a zone (a background load) are
+// left out.
+bool Profile_DumpTrace(const char* filename);
+
+#if BOOMER_PROFILE
+#define PROFILE_BEGIN(name) Profile_Begin(name)
+#define PROFILE_END() Profile_End()
+
+// Zone that ends with the enclosing block
+static inline void Profile_EndScope(const char** name) { (void)name; Profile_End(); }
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) \
+    const char* PROFILE_CONCAT(profile_scope_, __LINE__) __attribute__((cleanup(Profile_EndScope))) = (Profile_Begin(name), name)
+#else
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+#endif // BOOMER_PROFILER_H
@@ -1,5 +1,5 @@
 #include "script_sys.h"
-#include "fs.h"
+#include "cache.h"
 #include "../ui/console.h"
 #include <stdio.h>
 #include <string.h>
@@ -115,16 +115,16 @@ static JSModuleDef *js_module_loader(JSContext *ctx, const char *module_name, vo
         return m;
     }
     
-    // 3. Load file
+    // 3. Load file, shared with every other import of it
     size_t size;
-    char* data = FS_ReadFile(module_name, &size);
+    const char* data = Cache_ReadFile(module_name, &size);
     if (!data) {
         JS_ThrowReferenceError(ctx, "Could not load module '%s'", module_name);
         return NULL;
     }
     
     JSValue func_val = JS_Eval(ctx, data, size, module_name, JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
-    FS_FreeFile(data);
+    Cache_ReleaseFile(data);
     
     if (JS_IsException(func_val)) return NULL;
     
@@ -191,8 +191,9 @@ JSContext* Script_GetContext(void) {
 JSValue Script_EvalFile(const char* path) {
     if (!ctx) return JS_EXCEPTION;
     
+    // Entity scripts are evaluated on every spawn, so keep the source around
     size_t size;
-    char* data = FS_ReadFile(path, &size);
+    const char* data = Cache_ReadFile(path, &size);
     if (!data) {
         printf("Script: Could not read script '%s'\n", path);
         return JS_ThrowInternalError(ctx, "Could not read script file");
@@ -209,7 +210,7 @@ JSValue Script_EvalFile(const char* path) {
             JS_FreeCString(ctx, str);
         }
         JS_FreeValue(ctx, ex);
-        FS_FreeFile(data);
+        Cache_ReleaseFile(data);
         return JS_EXCEPTION; 
     }
     
@@ -254,13 +255,13 @@ JSValue Script_EvalFile(const char* path) {
             printf("Script: Uncaught exception in module '%s': %s\n", path, str);
             JS_FreeCString(ctx, str);
             JS_FreeValue(ctx, ex);
-            FS_FreeFile(data);
+            Cache_ReleaseFile(data);
             return JS_EXCEPTION;
          }
          JS_FreeValue(ctx, res); // Result of module eval (usually undefined)
     }
     
-    FS_FreeFile(data);
+    Cache_ReleaseFile(data);
     return val; // Return the Module object (or result?)
 }
 
@@ -1,4 +1,7 @@
 #include "entity.h"
+#include "../world/world.h"
+#include "../world/pvs.h"
+#include "../core/profiler.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -46,6 +49,28 @@ static JSValue js_Entity_GetPos(JSContext *ctx, JSValueConst this_val, int argc,
     return JS_NULL;
 }
 
+// bool = Entity.IsVisible(id)
+static JSValue js_Entity_IsVisible(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    if (argc < 1) return JS_EXCEPTION;
+    
+    uint32_t id;
+    if (JS_ToUint32(ctx, &id, argv[0])) return JS_EXCEPTION;
+    
+    Entity* e = Entity_Get(id);
+    return JS_NewBool(ctx, e && e->visible);
+}
+
+// sector = Entity.GetSector(id), -1 if outside the map
+static JSValue js_Entity_GetSector(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    if (argc < 1) return JS_EXCEPTION;
+    
+    uint32_t id;
+    if (JS_ToUint32(ctx, &id, argv[0])) return JS_EXCEPTION;
+    
+    Entity* e = Entity_Get(id);
+    return JS_NewInt32(ctx, e ? e->sector : -1);
+}
+
 void Entity_Init(void) {
     memset(g_entities, 0, sizeof(g_entities));
     g_next_id = 1;
@@ -67,6 +92,8 @@ void Entity_Init(void) {
     
     JS_SetPropertyStr(ctx, entity_obj, "SetPos", JS_NewCFunction(ctx, js_Entity_SetPos, "SetPos", 4));
     JS_SetPropertyStr(ctx, entity_obj, "GetPos", JS_NewCFunction(ctx, js_Entity_GetPos, "GetPos", 1));
+    JS_SetPropertyStr(ctx, entity_obj, "IsVisible", JS_NewCFunction(ctx, js_Entity_IsVisible, "IsVisible", 1));
+    JS_SetPropertyStr(ctx, entity_obj, "GetSector", JS_NewCFunction(ctx, js_Entity_GetSector, "GetSector", 1));
     
     JS_SetPropertyStr(ctx, global_obj, "Entity", entity_obj);
     JS_FreeValue(ctx, global_obj);
@@ -174,6 +201,13 @@ u32 Entity_Spawn(const char* script_path, Vec3 pos) {
     e->pos = pos;
     e->vel = (Vec3){0,0,0};
     e->yaw = 0;
+    e->sector = -1;
+    e->visible = true;
+    
+    // Opt-in: don't think while out of sight
+    JSValue cull = JS_GetPropertyStr(ctx, instance, "cullThink");
+    e->cull_think = JS_ToBool(ctx, cull) > 0;
+    JS_FreeValue(ctx, cull);
     
     // Set 'id' in Instance
     JS_SetPropertyStr(ctx, instance, "id", JS_NewInt32(ctx, e->id));
@@ -184,6 +218,16 @@ u32 Entity_Spawn(const char* script_path, Vec3 pos) {
     return e->id;
 }
 
+void Entity_UpdateVisibility(Map* map, SectorID view_sector) {
+    for (int i=0; i<MAX_ENTITIES; ++i) {
+        Entity* e = &g_entities[i];
+        if (!e->active) continue;
+        
+        e->sector = TrackSector(map, e->sector, (Vec2){e->pos.x, e->pos.y});
+        e->visible = PVS_IsVisible(map, view_sector, e->sector);
+    }
+}
+
 void Entity_Update(f32 dt) {
     JSContext* ctx = Script_GetContext();
     if (!ctx) return;
@@ -192,26 +236,29 @@ void Entity_Update(f32 dt) {
         Entity* e = &g_entities[i];
         if (!e->active) continue;
         
-        // Call instance.think(dt)
-        JSValue think_func = JS_GetPropertyStr(ctx, e->instance_js, "think");
-        if (JS_IsFunction(ctx, think_func)) {
-            JSValue args[1];
-            args[0] = JS_NewFloat64(ctx, dt);
-            
-            JSValue ret = JS_Call(ctx, think_func, e->instance_js, 1, args);
-            
-            if (JS_IsException(ret)) {
-                printf("Entity %d Think Error\n", e->id);
-                JSValue ex = JS_GetException(ctx);
-                const char* s = JS_ToCString(ctx, ex);
-                if (s) { printf("%s\n", s); JS_FreeCString(ctx, s); }
-                JS_FreeValue(ctx, ex);
+        // Call instance.think(dt), unless the script opted out while unseen
+        if (!e->cull_think || e->visible) {
+            PROFILE_SCOPE("JS think");
+            JSValue think_func = JS_GetPropertyStr(ctx, e->instance_js, "think");
+            if (JS_IsFunction(ctx, think_func)) {
+                JSValue args[1];
+                args[0] = JS_NewFloat64(ctx, dt);
+                
+                JSValue ret = JS_Call(ctx, think_func, e->instance_js, 1, args);
+                
+                if (JS_IsException(ret)) {
+                    printf("Entity %d Think Error\n", e->id);
+                    JSValue ex = JS_GetException(ctx);
+                    const char* s = JS_ToCString(ctx, ex);
+                    if (s) { printf("%s\n", s); JS_FreeCString(ctx, s); }
+                    JS_FreeValue(ctx, ex);
+                }
+                
+                JS_FreeValue(ctx, ret);
+                JS_FreeValue(ctx, args[0]);
             }
-            
-            JS_FreeValue(ctx, ret);
-            JS_FreeValue(ctx, args[0]);
+            JS_FreeValue(ctx, think_func);
         }
-        JS_FreeValue(ctx, think_func);
         
         // Physics integration (simple)
         e->pos.x += e->vel.x * dt;
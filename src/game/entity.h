@@ -2,6 +2,7 @@
 #define BOOMER_ENTITY_H
 
 #include "../core/types.h"
+#include "../world/world_types.h"
 
 #include "../core/script_sys.h"
 
@@ -14,6 +15,11 @@ typedef struct {
     Vec3 vel;
     f32 yaw;
     
+    // Visibility, refreshed by Entity_UpdateVisibility
+    SectorID sector;    // Tracked from frame to frame, -1 if outside the map
+    bool visible;       // In the PVS of the camera's sector
+    bool cull_think;    // Skip think() while not visible (instance.cullThink)
+    
     // Scripting
     JSValue instance_js; // Reference to the Instance Object
 } Entity;
@@ -22,6 +28,10 @@ void Entity_Init(void);
 void Entity_Shutdown(void);
 void Entity_Update(f32 dt);
 
+// Update each entity's sector (see TrackSector) and whether it is potentially visible from
+// view_sector (see pvs.h). Call once per frame before Entity_Update.
+void Entity_UpdateVisibility(Map* map, SectorID view_sector);
+
 // Spawns an entity using a script.
 // The script should return a "Class" table (factory).
 // Returns ID of new entity.
@@ -1,5 +1,7 @@
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include "raylib.h"
 
 #ifdef __EMSCRIPTEN__
@@ -12,12 +14,18 @@
 #include "render/renderer.h"
 #include "world/world_types.h"
 #include "world/map_loader.h"
+#include "world/world.h"
 #include "core/fs.h"
+#include "core/cache.h"
 #include "core/script_sys.h"
 #include "core/config.h"      // Added
+#include "core/jobs.h"
+#include "core/profiler.h"
+#include "core/clock.h"
 #include "game/entity.h"
 #include "editor/editor.h"
 #include "ui/console.h"       // Added
+#include "ui/perf_overlay.h"
 
 // JS Binding for Map Loading
 static JSValue js_load_map(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
@@ -52,6 +60,8 @@ typedef struct {
 static bool running = true;
 static InputState input = {false};
 static bool editor_has_focus = false;
+static int frame_limit = 0; // Quit after this many frames, 0 = never (--frames)
+static int frame_count = 0;
 
 static TextureID tex_wall;
 static TextureID tex_floor;
@@ -59,26 +69,35 @@ static TextureID tex_ceil;
 static TextureID tex_wood;
 
 // World Data
+//  5-----4
+//  |     |
+//  |  0  3-----7-----9
+//  |     |  1  |  2  |
+//  |     2-----6-----8
+//  0-----1
+static f32 vertex_x[] = { 0, 4, 4, 4, 4, 0, 8, 8, 10, 10 };
+static f32 vertex_y[] = { 0, 0, 1, 3, 4, 4, 1, 3, 1, 3 };
+
 static Wall walls[] = {
     // Sector 0 (0-5)
-    { {0, 0}, {4, 0}, -1, 0, -1, -1 }, // TexIDs set in Init
-    { {4, 0}, {4, 1}, -1, 0, -1, -1 },
-    { {4, 1}, {4, 3},  1, -1, 0, 0 }, // P->1
-    { {4, 3}, {4, 4}, -1, 0, -1, -1 },
-    { {4, 4}, {0, 4}, -1, 0, -1, -1 },
-    { {0, 4}, {0, 0}, -1, 0, -1, -1 },
-    
-    // Sector 1 (6-11)
-    { {4, 1}, {8, 1}, -1, 0, -1, -1 }, // Top wall
-    { {8, 1}, {8, 3},  2, -1, 0, 0 }, // P->2 (East)
-    { {8, 3}, {4, 3}, -1, 0, -1, -1 }, // Bottom wall
-    { {4, 3}, {4, 1},  0, -1, 0, 0 }, // P->0 (West)
+    { .v1 = 0, .v2 = 1, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 }, // TexIDs set in Init
+    { .v1 = 1, .v2 = 2, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 },
+    { .v1 = 2, .v2 = 3, .next_sector = 1, .texture_id = -1, .top_texture_id = 0, .bottom_texture_id = 0 }, // P->1
+    { .v1 = 3, .v2 = 4, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 },
+    { .v1 = 4, .v2 = 5, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 },
+    { .v1 = 5, .v2 = 0, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 },
+    
+    // Sector 1 (6-9)
+    { .v1 = 2, .v2 = 6, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 }, // Top wall
+    { .v1 = 6, .v2 = 7, .next_sector = 2, .texture_id = -1, .top_texture_id = 0, .bottom_texture_id = 0 }, // P->2 (East)
+    { .v1 = 7, .v2 = 3, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 }, // Bottom wall
+    { .v1 = 3, .v2 = 2, .next_sector = 0, .texture_id = -1, .top_texture_id = 0, .bottom_texture_id = 0 }, // P->0 (West)
     
     // Sector 2 (10-13) - Let's make it a small room
-    { {8, 1}, {10, 1}, -1, 0, -1, -1 },
-    { {10, 1}, {10, 3}, -1, 0, -1, -1 },
-    { {10, 3}, {8, 3}, -1, 0, -1, -1 },
-    { {8, 3}, {8, 1},  1, -1, 0, 0 } // P->1
+    { .v1 = 6, .v2 = 8, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 },
+    { .v1 = 8, .v2 = 9, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 },
+    { .v1 = 9, .v2 = 7, .next_sector = -1, .texture_id = 0, .top_texture_id = -1, .bottom_texture_id = -1 },
+    { .v1 = 7, .v2 = 6, .next_sector = 1, .texture_id = -1, .top_texture_id = 0, .bottom_texture_id = 0 } // P->1
 };
 
 static Sector sectors[] = {
@@ -88,6 +107,9 @@ static Sector sectors[] = {
 };
 
 static Map map = {
+    .vertex_x = vertex_x,
+    .vertex_y = vertex_y,
+    .vertex_count = 10,
     .walls = walls,
     .wall_count = 14,
     .sectors = sectors,
@@ -96,18 +118,18 @@ static Map map = {
 
 static GameCamera cam = {
     .pos = {2.0f, 2.0f, 0.75f}, // Start inside Sector 0
-    .yaw = 0.0f
+    .yaw = 0.0f,
+    .sector = -1
 };
 
-// Moved binding here to access 'map'
-static JSValue js_load_map_wrapper(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
-    if (argc < 1) return JS_EXCEPTION;
-    const char* filename = JS_ToCString(ctx, argv[0]);
-    if (!filename) return JS_EXCEPTION;
-    
-    bool res = Map_Load(filename, &map);
-    
-    if (res) {
+// Callbacks of a loadMap() running in the background (see PollMapLoad)
+static bool map_loading = false;
+static JSValue load_on_done;
+static JSValue load_on_progress;
+static char load_name[256];
+
+static void OnMapLoaded(const char* filename, bool ok) {
+    if (ok) {
         Console_SetMapLoaded(true);
         Console_Close(); // Auto-hide console
         // Reset camera if needed? Or controlled by script?
@@ -116,21 +138,97 @@ static JSValue js_load_map_wrapper(JSContext *ctx, JSValueConst this_val, int ar
     } else {
         printf("Failed to load map '%s' via script.\n", filename);
     }
+}
+
+// Moved binding here to access 'map'
+// loadMap(name) loads right away and returns whether it worked.
+// loadMap(name, onDone[, onProgress]) loads in the background and returns
+// whether the load started; onProgress(0..1) is called every frame until
+// onDone(ok) once the new map is in place.
+static JSValue js_load_map_wrapper(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    if (argc < 1) return JS_EXCEPTION;
+    const char* filename = JS_ToCString(ctx, argv[0]);
+    if (!filename) return JS_EXCEPTION;
+    
+    bool res;
+    if (argc >= 2 && JS_IsFunction(ctx, argv[1])) {
+        res = !map_loading && Map_LoadAsync(filename);
+        if (res) {
+            map_loading = true;
+            snprintf(load_name, sizeof(load_name), "%s", filename);
+            load_on_done = JS_DupValue(ctx, argv[1]);
+            load_on_progress = (argc >= 3) ? JS_DupValue(ctx, argv[2]) : JS_UNDEFINED;
+        }
+    } else {
+        res = Map_Load(filename, &map);
+        OnMapLoaded(filename, res);
+    }
     
     JS_FreeCString(ctx, filename);
     return JS_NewBool(ctx, res);
 }
 
+static void CallLoadCallback(JSContext* ctx, JSValue func, JSValue arg) {
+    if (!JS_IsFunction(ctx, func)) return;
+    
+    JSValue ret = JS_Call(ctx, func, JS_UNDEFINED, 1, &arg);
+    if (JS_IsException(ret)) {
+        printf("loadMap: Callback Error\n");
+        JSValue ex = JS_GetException(ctx);
+        const char* s = JS_ToCString(ctx, ex);
+        if (s) { printf("%s\n", s); JS_FreeCString(ctx, s); }
+        JS_FreeValue(ctx, ex);
+    }
+    JS_FreeValue(ctx, ret);
+}
+
+// Report progress of a background load, or swap the new map in once it is done
+static void PollMapLoad(void) {
+    JSContext* ctx = Script_GetContext();
+    f32 progress = 0.0f;
+    MapLoadStatus status = Map_PollLoad(&map, &progress);
+    
+    if (status == MAP_LOAD_PENDING) {
+        CallLoadCallback(ctx, load_on_progress, JS_NewFloat64(ctx, progress));
+        return;
+    }
+    
+    // The callback may start the next load, so clear the state first
+    bool ok = (status == MAP_LOAD_DONE);
+    JSValue on_done = load_on_done;
+    JSValue on_progress = load_on_progress;
+    map_loading = false;
+    
+    OnMapLoaded(load_name, ok);
+    CallLoadCallback(ctx, on_done, JS_NewBool(ctx, ok));
+    JS_FreeValue(ctx, on_done);
+    JS_FreeValue(ctx, on_progress);
+}
+
+// Drop a background load that has not finished, at shutdown
+static void CancelMapLoad(void) {
+    if (!map_loading) return;
+    
+    Map_CancelLoad();
+    JS_FreeValue(Script_GetContext(), load_on_done);
+    JS_FreeValue(Script_GetContext(), load_on_progress);
+    map_loading = false;
+}
+
 
 // --- Loop Function ---
 void Loop(void) {
-    if (!running || WindowShouldClose()) {
+    if (!running || Video_ShouldClose()) {
         running = false;
         #ifdef __EMSCRIPTEN__
         emscripten_cancel_main_loop();
         #endif
         return;
     }
+    
+    f64 frame_start = Clock_Now();
+    PROFILE_BEGIN("Frame");
+    PROFILE_BEGIN("Input");
 
     // Input Poll - Handled by Raylib
     
@@ -163,6 +261,12 @@ void Loop(void) {
         Editor_InputEnd();
     }
 
+    if (IsKeyPressed(KEY_F3)) {
+        PerfOverlay_Toggle();
+    }
+    if (IsKeyPressed(KEY_F4)) {
+        Profile_DumpTrace("trace.json");
+    }
     if (IsKeyPressed(KEY_F9)) {
         Video_ChangeScale(-1);
     }
@@ -193,8 +297,10 @@ void Loop(void) {
     } else {
             input = (InputState){0};
     }
+    PROFILE_END(); // Input
 
-    f32 dt = GetFrameTime();
+    // Headless runs have no frame timing; step at a fixed 60 Hz
+    f32 dt = Video_IsHeadless() ? (1.0f / 60.0f) : GetFrameTime();
     
     // Cam Update
     f32 move_speed = 3.0f * dt;
@@ -225,7 +331,14 @@ void Loop(void) {
     if (input.u) cam.pos.z += move_speed;
     if (input.d) cam.pos.z -= move_speed;
     
+    // A map loaded in the background is swapped in here, between frames
+    if (map_loading) PollMapLoad();
+    
+    PROFILE_BEGIN("Entity_Update");
+    cam.sector = TrackSector(&map, cam.sector, (Vec2){cam.pos.x, cam.pos.y});
+    Entity_UpdateVisibility(&map, cam.sector);
     Entity_Update(dt);
+    PROFILE_END();
 
     // --- RENDER PIPELINE ---
     Video_BeginFrame();
@@ -236,6 +349,7 @@ void Loop(void) {
         int view = Editor_GetViewMode();
         if (view == 0) {
             Render_Frame(cam, &map);
+            PerfOverlay_Draw();
             Video_DrawGame(NULL); 
         } else {
              int w = GetScreenWidth();
@@ -250,21 +364,53 @@ void Loop(void) {
         // GAME MODE
         Video_Clear((Color){20, 20, 30, 255}); 
         Render_Frame(cam, &map);
+        PerfOverlay_Draw();
         Video_DrawGame(NULL);
     }
     
     // Draw Console (Overlay)
+    PROFILE_BEGIN("Console_Draw");
     Console_Update(dt);
-    Console_Draw();
+    if (!Video_IsHeadless()) Console_Draw();
+    PROFILE_END();
 
+    // Work done this frame, before waiting for vsync
+    f32 frame_ms = (f32)((Clock_Now() - frame_start) * 1000.0);
+
+    PROFILE_BEGIN("Video_EndFrame"); // Includes waiting for vsync
     Video_EndFrame();
+    PROFILE_END();
+    PROFILE_END(); // Frame
+    
+    // Pick the render size for the next frame
+    Video_UpdateDynamicResolution(frame_ms);
+    
+    if (frame_limit > 0 && ++frame_count >= frame_limit) {
+        running = false;
+    }
 }
 
 
 int main(int argc, char** argv) {
     const char* asset_path = "games/demo";
-    if (argc > 1) {
-        asset_path = argv[1];
+    bool headless = false;
+    const char* frame_output = NULL;
+    
+    Profile_Init();
+    
+    // boomer [--headless] [--frames N] [--frame-output path] [game_pak_or_dir]
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frame_limit = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frame-output") == 0 && i + 1 < argc) {
+            frame_output = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            printf("WARNING: Unknown option '%s'\n", argv[i]);
+        } else {
+            asset_path = argv[i];
+        }
     }
     
     // 0. Init FS
@@ -283,6 +429,16 @@ int main(int argc, char** argv) {
     
     // 0.2 Load Config
     Config_Load();
+    Cache_SetBudget((size_t)Config_Get()->resource_cache_mb * 1024 * 1024);
+    
+    // 0.25 Pick the video backend
+    if (headless || Config_Get()->headless) {
+        Video_SetBackend(VIDEO_BACKEND_NULL);
+        Video_SetFrameOutput(frame_output);
+    }
+    
+    // 0.3 Init Worker Threads (Renderer bands)
+    Jobs_Init(Config_Get()->render_threads);
 
     // 0.5 Init Script System
     if (!Script_Init()) {
@@ -293,14 +449,15 @@ int main(int argc, char** argv) {
     
     // 0.6 Init Entity System
     Entity_Init();
+    PerfOverlay_Init();
 
     // 1. Initialize Video
     if (!Video_Init("Boomer Engine")) {
         return 1;
     }
     
-    // Init Console (After Video)
-    Console_Init();
+    // Init Console (After Video, needs a GL context)
+    if (!Video_IsHeadless()) Console_Init();
     
     // Init Editor
     Editor_Init();
@@ -309,6 +466,8 @@ int main(int argc, char** argv) {
     Texture_Init();
 
     // 2. Load Map (Via Script now)
+    // Until a script does, the built-in map needs its derived wall data
+    Map_UpdateWallGeometry(&map);
     // if( !Map_Load("test.json", &map) ) ... REMOVED hardcoded load
 
     // 2.5 Run Main Script
@@ -323,16 +482,21 @@ int main(int argc, char** argv) {
 #ifdef __EMSCRIPTEN__
     emscripten_set_main_loop(Loop, 0, 1);
 #else
-    while (running && !WindowShouldClose()) {
+    while (running && !Video_ShouldClose()) {
         Loop();
     }
     
     Console_Shutdown();
     Editor_Shutdown();
+    CancelMapLoad();
+    Map_Free(&map);
     Video_Shutdown();
     Texture_Shutdown();
     Entity_Shutdown();
     Script_Shutdown();
+    Cache_Shutdown();
+    Jobs_Shutdown();
+    Profile_Shutdown();
     FS_Shutdown();
 #endif
 
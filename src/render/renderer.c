@@ -2,8 +2,14 @@
 #include "../video/video.h"
 #include "../video/texture.h"
 #include "../core/math_utils.h"
+#include "../core/jobs.h"
+#include "../core/profiler.h"
+#include "../world/pvs.h"
+#include "../world/world.h"
 #include "raylib.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifndef max
 #define max(a,b) ((a) > (b) ? (a) : (b))
@@ -16,34 +22,242 @@
 #define FOV_H (90.0f * DEG2RAD)
 #define NEAR_Z 0.1f
 #define MAX_RECURSION 16
+#define MIN_BAND_WIDTH 16 // Narrower bands cost more in duplicated portal walks than they save
+#define MAX_RENDER_BANDS 64
+#define MAX_VISPLANES 128
+#define PLANE_UNUSED 0x7FFF // Visplane column top marking an unused column
+
+#if BOOMER_RENDER_STATS
+#define STAT_ADD(ctx, field, n) ((ctx)->stats.field += (u32)(n))
+#define STAT_MAX(ctx, field, n) ((ctx)->stats.field = max((ctx)->stats.field, (u32)(n)))
+#else
+#define STAT_ADD(ctx, field, n) ((void)0)
+#define STAT_MAX(ctx, field, n) ((void)0)
+#endif
+
+// Floor or ceiling area sharing one height and texture, as column ranges
+typedef struct {
+    f32 height;         // World height
+    TextureID tex_id;
+    int min_x, max_x;   // Columns touched (inclusive)
+    i16 top[MAX_VIDEO_WIDTH]; // PLANE_UNUSED if the column is not covered
+    i16 bot[MAX_VIDEO_WIDTH];
+} Visplane;
+
+// Vertical clip range per column for columns [x1, x2), stored in the clip arena
+typedef struct {
+    i16* top;   // Open rows of each column (inclusive); top > bot means closed
+    i16* bot;
+    int x1, x2;
+} ClipWindow;
+
+// One sector on the portal walk stack
+typedef struct {
+    SectorID sector_id;
+    u32 next_wall;      // Next wall of the sector to process
+    int depth;
+    ClipWindow clip;
+} PortalFrame;
+
+// Columns [x1, x2) of the screen
+typedef struct {
+    i16 x1, x2;
+} ColumnRange;
+
+// Disjoint, non-touching ranges can't outnumber half the columns
+#define MAX_CLOSED_RANGES (MAX_VIDEO_WIDTH / 2 + 2)
+
+// Clip windows live on a stack: a frame's window is released when it is
+// popped, so at most one window per depth level is alive at once
+#define CLIP_ARENA_SIZE ((MAX_RECURSION + 1) * 2 * MAX_VIDEO_WIDTH)
+
+// Per-band render state
+typedef struct {
+    int min_x, max_x;   // Band columns [min_x, max_x)
+    Visplane planes[MAX_VISPLANES];
+    int plane_count;
+    int span_start[MAX_VIDEO_HEIGHT]; // Start column of the open span on each row
+    
+    PortalFrame stack[MAX_RECURSION + 1];
+    i16 clip_arena[CLIP_ARENA_SIZE];
+    int clip_used;
+    
+    // Occlusion: sorted ranges of columns nothing more can be drawn in,
+    // because a solid wall or a shut portal filled them
+    ColumnRange closed[MAX_CLOSED_RANGES];
+    int closed_count;
+    int open_columns;   // Band columns not yet closed
+    ColumnRange closing[MAX_CLOSED_RANGES]; // Columns the current wall closes
+    int closing_count;
+    
+#if BOOMER_RENDER_STATS
+    RenderStats stats;  // This band's share of the frame
+#endif
+} RenderContext;
+
+// Screen-space projection tables for one resolution
+typedef struct {
+    int width, height;
+    f32 scale;                          // Pixels per unit at depth 1
+    f32 center_x, center_y;
+    f32 col_view_x[MAX_VIDEO_WIDTH];    // Camera-space ray slope per column: (x - cx) / scale
+    f32 row_inv_dy[MAX_VIDEO_HEIGHT];   // 1 / (y - cy) per row, 0 on the horizon row
+} ProjectionTables;
+
+// Everything the walk needs about the camera, built once per frame in
+// Render_Frame and read-only while the bands render
+typedef struct {
+    GameCamera cam;
+    SectorID sector;                    // Sector holding the camera, -1 if outside the map
+    f32 cos_yaw, sin_yaw;               // View rotation
+    const ProjectionTables* proj;
+    f32 col_ray_x[MAX_VIDEO_WIDTH];     // World-space ray direction per column at unit depth
+    f32 col_ray_y[MAX_VIDEO_WIDTH];
+    f32 ray_step_x, ray_step_y;         // Ray direction change per column
+    
+    // Every map vertex in camera space (see TransformVertices)
+    const f32* vertex_depth;            // Distance along the view direction
+    const f32* vertex_side;             // Distance to the right of the view
+} RenderView;
+
+// Tables are kept per resolution so switching back and forth costs nothing
+#define MAX_PROJECTION_TABLES 8
+static ProjectionTables g_proj_tables[MAX_PROJECTION_TABLES];
+static int g_proj_table_count = 0;
+static int g_proj_table_next = 0; // Slot to replace once all are in use
+
+static RenderView g_view;
+static RenderStats g_stats;
+
+// Vertex cache backing g_view.vertex_depth/side, grown to fit the map
+static f32* g_vertex_depth = NULL;
+static f32* g_vertex_side = NULL;
+static u32 g_vertex_capacity = 0;
+
+static const ProjectionTables* GetProjectionTables(int width, int height) {
+    for (int i = 0; i < g_proj_table_count; ++i) {
+        if (g_proj_tables[i].width == width && g_proj_tables[i].height == height) {
+            return &g_proj_tables[i];
+        }
+    }
+    
+    ProjectionTables* t;
+    if (g_proj_table_count < MAX_PROJECTION_TABLES) {
+        t = &g_proj_tables[g_proj_table_count++];
+    } else {
+        t = &g_proj_tables[g_proj_table_next];
+        g_proj_table_next = (g_proj_table_next + 1) % MAX_PROJECTION_TABLES;
+    }
+    
+    t->width = width;
+    t->height = height;
+    t->scale = (width / 2.0f) / tanf(FOV_H / 2.0f);
+    t->center_x = width / 2.0f;
+    t->center_y = height / 2.0f;
+    
+    for (int x = 0; x < width; ++x) {
+        t->col_view_x[x] = (x - t->center_x) / t->scale;
+    }
+    for (int y = 0; y < height; ++y) {
+        t->row_inv_dy[y] = (y == (int)t->center_y) ? 0.0f : 1.0f / ((f32)y - t->center_y);
+    }
+    
+    return t;
+}
+
+static void SetupView(RenderView* view, GameCamera cam, SectorID sector) {
+    const ProjectionTables* proj = GetProjectionTables(VIDEO_WIDTH, VIDEO_HEIGHT);
+    
+    view->cam = cam;
+    view->sector = sector;
+    view->cos_yaw = cosf(cam.yaw);
+    view->sin_yaw = sinf(cam.yaw);
+    view->proj = proj;
+    
+    for (int x = 0; x < proj->width; ++x) {
+        f32 vx = proj->col_view_x[x];
+        view->col_ray_x[x] = view->cos_yaw + vx * view->sin_yaw;
+        view->col_ray_y[x] = view->sin_yaw - vx * view->cos_yaw;
+    }
+    view->ray_step_x = view->sin_yaw / proj->scale;
+    view->ray_step_y = -view->cos_yaw / proj->scale;
+}
+
+// Move every map vertex into camera space, once per frame. Walls share
+// vertices and sectors are entered through several portals (and by every
+// band), so the walk only looks up transformed positions. The SoA loop has
+// no dependencies between iterations and is vectorized by the compiler;
+// at these vertex counts transforming the whole map beats picking out the
+// PVS subset.
+static bool TransformVertices(RenderView* view, const Map* map) {
+    if (map->vertex_count > g_vertex_capacity) {
+        u32 capacity = max(map->vertex_count, g_vertex_capacity * 2);
+        f32* depth = (f32*)realloc(g_vertex_depth, sizeof(f32) * capacity);
+        if (depth) g_vertex_depth = depth;
+        f32* side = (f32*)realloc(g_vertex_side, sizeof(f32) * capacity);
+        if (side) g_vertex_side = side;
+        if (!depth || !side) return false;
+        g_vertex_capacity = capacity;
+    }
+    
+    const f32* restrict wx = map->vertex_x;
+    const f32* restrict wy = map->vertex_y;
+    f32* restrict out_depth = g_vertex_depth;
+    f32* restrict out_side = g_vertex_side;
+    f32 px = view->cam.pos.x;
+    f32 py = view->cam.pos.y;
+    f32 cs = view->cos_yaw;
+    f32 sn = view->sin_yaw;
+    
+    // Same arithmetic as TransformToCamera
+    for (u32 i = 0; i < map->vertex_count; ++i) {
+        f32 lx = wx[i] - px;
+        f32 ly = wy[i] - py;
+        out_depth[i] = lx * cs + ly * sn;
+        out_side[i] = lx * sn - ly * cs;
+    }
+    
+    view->vertex_depth = g_vertex_depth;
+    view->vertex_side = g_vertex_side;
+    return true;
+}
 
 void Renderer_Init(void) {
-    // any Pre-calc tables here
+    GetProjectionTables(VIDEO_WIDTH, VIDEO_HEIGHT);
+}
+
+const RenderStats* Render_GetStats(void) {
+    return &g_stats;
 }
 
 // Transform World Position to Camera Relative (Rotated & Translated)
 // P_cam = Rot(-Yaw) * (P_world - Cam_pos)
-static Vec3 TransformToCamera(Vec3 p, GameCamera cam) {
-    Vec3 local = vec3_sub(p, cam.pos);
-    f32 cs = cosf(-cam.yaw);
-    f32 sn = sinf(-cam.yaw);
+static Vec3 TransformToCamera(Vec3 p, const RenderView* view) {
+    Vec3 local = vec3_sub(p, view->cam.pos);
+    f32 cs = view->cos_yaw;
+    f32 sn = view->sin_yaw;
     
     return (Vec3){
-        local.x * cs - local.y * sn,
-        -(local.x * sn + local.y * cs), // Negate Y to map Left(+Y) -> camera Left(-Y) -> Screen Left
+        local.x * cs + local.y * sn,
+        local.x * sn - local.y * cs, // Negate Y to map Left(+Y) -> camera Left(-Y) -> Screen Left
         local.z
     };
 }
 
 bool WorldToScreen(Vec3 world_pos, GameCamera cam, Vec2* screen_out) {
-    Vec3 p = TransformToCamera(world_pos, cam);
+    const ProjectionTables* proj = GetProjectionTables(VIDEO_WIDTH, VIDEO_HEIGHT);
+    RenderView view = {
+        .cam = cam,
+        .cos_yaw = cosf(cam.yaw),
+        .sin_yaw = sinf(cam.yaw),
+        .proj = proj
+    };
+    Vec3 p = TransformToCamera(world_pos, &view);
     
     if (p.x < NEAR_Z) return false;
     
-    f32 scale = (VIDEO_WIDTH / 2.0f) / tanf(FOV_H / 2.0f);
-    
-    screen_out->x = (VIDEO_WIDTH / 2.0f) + (p.y / p.x) * scale;
-    screen_out->y = (VIDEO_HEIGHT / 2.0f) - (p.z / p.x) * scale;
+    screen_out->x = proj->center_x + (p.y / p.x) * proj->scale;
+    screen_out->y = proj->center_y - (p.z / p.x) * proj->scale;
     
     return true;
 }
@@ -77,288 +291,623 @@ static bool ClipWall(Vec3 p1, Vec3 p2, Vec3* out1, Vec3* out2, f32* t1, f32* t2,
     return true;
 }
 
-// Helper to draw Floor/Ceiling Span
-static void DrawFlat(int x, int y1, int y2, f32 height_diff, GameCamera cam, GameTexture* tex) {
-    if (y1 > y2) return;
-    if (!tex) {
-        Video_DrawVertLine(x, y1, y2, (Color){50, 50, 50, 255}); // Gray fallback
-        return;
+// --- Visplanes ---
+// Floors and ceilings are not drawn during the wall pass. Each wall column
+// records the rows its sector's floor and ceiling cover into a visplane (one
+// per height/texture pair with non-overlapping columns), and the planes are
+// drawn afterwards as horizontal spans. Every row of a span has a constant
+// distance, so texture stepping is linear and framebuffer writes sequential.
+
+// Find (or start) the plane for a height/texture pair. Needs a free slot,
+// see ReservePlanes.
+static Visplane* FindPlane(RenderContext* ctx, f32 height, TextureID tex_id) {
+    for (int i = 0; i < ctx->plane_count; ++i) {
+        Visplane* pl = &ctx->planes[i];
+        if (pl->height == height && pl->tex_id == tex_id) return pl;
     }
+    
+    Visplane* pl = &ctx->planes[ctx->plane_count++];
+    pl->height = height;
+    pl->tex_id = tex_id;
+    pl->min_x = ctx->max_x;
+    pl->max_x = -1;
+    for (int x = ctx->min_x; x < ctx->max_x; ++x) pl->top[x] = PLANE_UNUSED;
+    return pl;
+}
 
-    f32 cx = VIDEO_WIDTH / 2.0f;
-    f32 cy = VIDEO_HEIGHT / 2.0f;
-    f32 scale = (VIDEO_WIDTH / 2.0f) / tanf(FOV_H / 2.0f);
+// Make sure columns [start, stop] of the plane are free to be marked.
+// Returns the plane extended to cover them, or a fresh plane with the same
+// height and texture if any of them are already in use. Needs a free slot
+// unless pl was just started by FindPlane.
+static Visplane* CheckPlane(RenderContext* ctx, Visplane* pl, int start, int stop) {
+    int inter_l = max(start, pl->min_x);
+    int inter_r = min(stop, pl->max_x);
+    
+    int x = inter_l;
+    while (x <= inter_r && pl->top[x] == PLANE_UNUSED) ++x;
+    
+    if (x > inter_r) {
+        pl->min_x = min(pl->min_x, start);
+        pl->max_x = max(pl->max_x, stop);
+        return pl;
+    }
+    
+    Visplane* fresh = &ctx->planes[ctx->plane_count++];
+    fresh->height = pl->height;
+    fresh->tex_id = pl->tex_id;
+    fresh->min_x = start;
+    fresh->max_x = stop;
+    for (int i = ctx->min_x; i < ctx->max_x; ++i) fresh->top[i] = PLANE_UNUSED;
+    return fresh;
+}
 
-    // Ray Direction for this column
-    // Screen X -> normalized -1..1 -> view space dir
-    f32 screen_x_norm = (x - cx) / (VIDEO_WIDTH / 2.0f); // -1 to 1 (approx)
+static void MarkPlane(Visplane* pl, int x, int top, int bot) {
+    if (top > bot) return;
+    pl->top[x] = (i16)top;
+    pl->bot[x] = (i16)bot;
+}
+
+// Draw one row of a plane from x1 to x2 (inclusive).
+// False if the row was skipped (the horizon).
+static bool MapPlaneRow(Visplane* pl, GameTexture* tex, const RenderView* view, int y, int x1, int x2) {
+    if (!tex) {
+        Video_DrawHorizLine(y, x1, x2, (Color){50, 50, 50, 255}); // Gray fallback
+        return true;
+    }
+    
+    const ProjectionTables* proj = view->proj;
+    f32 inv_dy = proj->row_inv_dy[y];
+    if (inv_dy == 0.0f) return false; // Singularity
+    
+    // Planar distance of this row
+    f32 z = (pl->height - view->cam.pos.z) * proj->scale * inv_dy;
+    if (z < 0) z = -z;
+    
+    // World position along the row is linear in x: cam + z * ray(x)
+    f32 step_x = z * view->ray_step_x;
+    f32 step_y = z * view->ray_step_y;
+    f32 base_x = view->cam.pos.x + z * view->col_ray_x[0];
+    f32 base_y = view->cam.pos.y + z * view->col_ray_y[0];
     
-    // Actually, accurate ray dir:
-    // view_x = (x - cx) / scale
-    // view_y = 1.0 (depth)
-    // view_z = ... (handled by loop)
+    // Texels stepped per pixel grows with distance; pick the mip to match.
+    // Depends only on the row, so every band picks the same level.
+    u32 level;
+    tex = Texture_SelectMip(tex, sqrtf(step_x * step_x + step_y * step_y) * 64.0f, &level);
+    f32 texel_scale = 64.0f * 65536.0f / (f32)(1u << level);
     
-    // Rotated Ray Dir
-    f32 view_x = (x - cx) / scale;
-    f32 cs = cosf(cam.yaw);
-    f32 sn = sinf(cam.yaw);
+    // 16.16 fixed point texel coordinates (1 unit = 64 pixels at level 0),
+    // anchored at column 0 so a row gives the same texels however it is split
+    // into spans.
+    i64 du = (i64)(step_x * texel_scale);
+    i64 dv = (i64)(step_y * texel_scale);
+    i64 u = (i64)(base_x * texel_scale) + du * x1;
+    i64 v = (i64)(base_y * texel_scale) + dv * x1;
+    
+    Video_DrawTexturedSpan(y, x1, x2, tex, u, v, du, dv);
+    return true;
+}
 
-    // Correct Ray Dir derivation:
-    // ... (comments)
+// Turn the column ranges of a plane into horizontal spans
+static void DrawPlane(RenderContext* ctx, Visplane* pl, const RenderView* view) {
+    if (pl->min_x > pl->max_x) return;
     
-    f32 rdx = cs + view_x * sn;
-    f32 rdy = sn - view_x * cs;
+    GameTexture* tex = Texture_Get(pl->tex_id);
+    int* span_start = ctx->span_start;
     
-    // Correct for Fisheye?
-    // Z = height / pixel_y
-    // Distance = Z / cos(angle)?
-    // Standard Raycasting formula handles distance correct if we use planar Z.
+    // Previous column's range; empty is top > bot
+    int t1 = PLANE_UNUSED;
+    int b1 = -1;
     
-    for (int y = y1; y <= y2; ++y) {
-        if (y == (int)cy) continue; // Singularity
-        
-        f32 z = height_diff * scale / (f32)(y - cy);
-        if (z < 0) z = -z; // Distance is positive
+    for (int x = pl->min_x; x <= pl->max_x + 1; ++x) {
+        int t2 = PLANE_UNUSED;
+        int b2 = -1;
+        if (x <= pl->max_x && pl->top[x] != PLANE_UNUSED) {
+            t2 = pl->top[x];
+            b2 = pl->bot[x];
+        }
         
-        // World Pos
-        f32 wx = cam.pos.x + rdx * z;
-        f32 wy = cam.pos.y + rdy * z;
+        // Close rows that end here
+        while (t1 < t2 && t1 <= b1) {
+            if (MapPlaneRow(pl, tex, view, t1, span_start[t1], x - 1)) {
+                STAT_ADD(ctx, flat_pixels, x - span_start[t1]);
+            }
+            t1++;
+        }
+        while (b1 > b2 && b1 >= t1) {
+            if (MapPlaneRow(pl, tex, view, b1, span_start[b1], x - 1)) {
+                STAT_ADD(ctx, flat_pixels, x - span_start[b1]);
+            }
+            b1--;
+        }
         
-        // Texture Coords (1 unit = 64 pixels)
-        int tx = (int)(wx * 64.0f) % tex->width;
-        int ty = (int)(wy * 64.0f) % tex->height;
-        if (tx < 0) tx += tex->width;
-        if (ty < 0) ty += tex->height;
+        // Open rows that start here
+        while (t2 < t1 && t2 <= b2) {
+            span_start[t2] = x;
+            t2++;
+        }
+        while (b2 > b1 && b2 >= t2) {
+            span_start[b2] = x;
+            b2--;
+        }
         
-        u32 color = tex->pixels[ty * tex->width + tx];
-        video_pixels[y * VIDEO_WIDTH + x] = color;
+        if (x <= pl->max_x && pl->top[x] != PLANE_UNUSED) {
+            t1 = pl->top[x];
+            b1 = pl->bot[x];
+        } else {
+            t1 = PLANE_UNUSED;
+            b1 = -1;
+        }
     }
 }
 
-// Recursive Sector Render with Y-Clipping
-static void RenderSector(Map* map, GameCamera cam, SectorID sector_id, int min_x, int max_x, i16* y_top, i16* y_bot, int depth) {
-    if (depth > MAX_RECURSION) return;
-    if (min_x >= max_x) return;
+static void DrawPlanes(RenderContext* ctx, const RenderView* view) {
+    for (int i = 0; i < ctx->plane_count; ++i) {
+        DrawPlane(ctx, &ctx->planes[i], view);
+    }
+}
 
-    Sector* sector = &map->sectors[sector_id];
-    f32 scale = (VIDEO_WIDTH / 2.0f) / tanf(FOV_H / 2.0f);
-    f32 center_x = VIDEO_WIDTH / 2.0f;
-    f32 center_y = VIDEO_HEIGHT / 2.0f;
+// Make room for the floor and ceiling planes of one wall (one new plane
+// each at most). When the list is full the planes so far are drawn early and
+// the list starts over. That gives the same picture: rows marked into a
+// plane are never covered by walls drawn later, and a span's texels do not
+// depend on where a row is split.
+static void ReservePlanes(RenderContext* ctx, const RenderView* view) {
+    if (ctx->plane_count <= MAX_VISPLANES - 2) return;
     
-    GameTexture* floor_tex = Texture_Get(sector->floor_tex_id);
-    GameTexture* ceil_tex = Texture_Get(sector->ceil_tex_id);
+    DrawPlanes(ctx, view);
+    ctx->plane_count = 0;
+    STAT_ADD(ctx, plane_flushes, 1);
+}
 
-    for (u32 w = 0; w < sector->num_walls; ++w) {
-        WallID wid = sector->first_wall + w;
-        Wall* wall = &map->walls[wid];
-        
-        // 1. Transform & Clip
-        Vec3 p1_world = { wall->p2.x, wall->p2.y, 0 }; 
-        Vec3 p2_world = { wall->p1.x, wall->p1.y, 0 };
-        
-        f32 dx = p2_world.x - p1_world.x;
-        f32 dy = p2_world.y - p1_world.y;
-        f32 wall_len = sqrtf(dx*dx + dy*dy);
-        
-        Vec3 p1_cam = TransformToCamera(p1_world, cam);
-        Vec3 p2_cam = TransformToCamera(p2_world, cam);
-        
-        Vec3 c1, c2;
-        f32 t1_clip, t2_clip;
-        bool portal = (wall->next_sector != -1);
-        f32 clip_dist = portal ? 0.005f : NEAR_Z; // Use closer clip for portals to prevent blinking
+// Take a clip window for columns [x1, x2) from the arena
+static void AllocClip(RenderContext* ctx, ClipWindow* clip, int x1, int x2) {
+    int span = x2 - x1;
+    clip->top = &ctx->clip_arena[ctx->clip_used];
+    clip->bot = clip->top + span;
+    clip->x1 = x1;
+    clip->x2 = x2;
+    ctx->clip_used += span * 2;
+}
 
-        if (!ClipWall(p1_cam, p2_cam, &c1, &c2, &t1_clip, &t2_clip, clip_dist)) continue;
-        
-        // 2. Project X
-        f32 x1 = center_x + (c1.y / c1.x) * scale;
-        f32 x2 = center_x + (c2.y / c2.x) * scale;
-        
-        if (x1 >= x2) continue; // Cull
-        
-        // 4. Clip to Window
-        int ix1 = (int)ceilf(x1);
-        int ix2 = (int)ceilf(x2);
-        
-        int draw_x1 = (ix1 < min_x) ? min_x : ix1;
-        int draw_x2 = (ix2 > max_x) ? max_x : ix2;
+// Index of the first closed range that ends after column x
+static int FindClosedRange(const RenderContext* ctx, int x) {
+    int lo = 0;
+    int hi = ctx->closed_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (ctx->closed[mid].x2 <= x) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// True if every column in [x1, x2) is closed
+static bool IsRangeClosed(const RenderContext* ctx, int x1, int x2) {
+    int i = FindClosedRange(ctx, x1);
+    return i < ctx->closed_count && ctx->closed[i].x1 <= x1 && ctx->closed[i].x2 >= x2;
+}
+
+// Merge [x1, x2) into the closed list
+static void CloseColumns(RenderContext* ctx, int x1, int x2) {
+    // Ranges overlapping or touching [x1, x2) are [first, last)
+    int first = FindClosedRange(ctx, x1 - 1);
+    int last = first;
+    int nx1 = x1;
+    int nx2 = x2;
+    while (last < ctx->closed_count && ctx->closed[last].x1 <= x2) {
+        nx1 = min(nx1, ctx->closed[last].x1);
+        nx2 = max(nx2, ctx->closed[last].x2);
+        ctx->open_columns += ctx->closed[last].x2 - ctx->closed[last].x1;
+        ++last;
+    }
+    ctx->open_columns -= nx2 - nx1;
+    
+    memmove(&ctx->closed[first + 1], &ctx->closed[last], sizeof(ColumnRange) * (ctx->closed_count - last));
+    ctx->closed_count += 1 - (last - first);
+    ctx->closed[first] = (ColumnRange){ (i16)nx1, (i16)nx2 };
+}
+
+// Note that the current wall closes column x (columns arrive in order)
+static void MarkClosing(RenderContext* ctx, int x) {
+    if (ctx->closing_count > 0 && ctx->closing[ctx->closing_count - 1].x2 == x) {
+        ctx->closing[ctx->closing_count - 1].x2++;
+        return;
+    }
+    ctx->closing[ctx->closing_count++] = (ColumnRange){ (i16)x, (i16)(x + 1) };
+}
+
+// Draw one wall of the sector in frame. If the wall is a portal that should be
+// walked, fills child with the next sector and its clip window and returns true.
+static bool RenderWall(RenderContext* ctx, Map* map, const RenderView* view, const PortalFrame* frame, WallID wid, PortalFrame* child) {
+    Sector* sector = &map->sectors[frame->sector_id];
+    const GameCamera* cam = &view->cam;
+    f32 scale = view->proj->scale;
+    f32 center_x = view->proj->center_x;
+    f32 center_y = view->proj->center_y;
+    
+    const ClipWindow* clip = &frame->clip;
+    int min_x = clip->x1;
+    int max_x = clip->x2;
+    
+    Wall* wall = &map->walls[wid];
+    
+    // 1. Transform & Clip
+    STAT_ADD(ctx, walls_transformed, 1);
+    
+    // Seen from behind: the camera is outside the wall's line
+    f32 side = (cam->pos.x - map->vertex_x[wall->v1]) * wall->normal.x + (cam->pos.y - map->vertex_y[wall->v1]) * wall->normal.y;
+    if (side < 0) {
+        STAT_ADD(ctx, walls_culled, 1);
+        return false;
+    }
+    
+    // Walls run v1 -> v2 with the sector on their left, so on screen they
+    // go from v2 (left) to v1 (right)
+    f32 local_z = -cam->pos.z;
+    Vec3 p1_cam = { view->vertex_depth[wall->v2], view->vertex_side[wall->v2], local_z };
+    Vec3 p2_cam = { view->vertex_depth[wall->v1], view->vertex_side[wall->v1], local_z };
+    
+    Vec3 c1, c2;
+    f32 t1_clip, t2_clip;
+    bool portal = (wall->next_sector != -1);
+    f32 clip_dist = portal ? 0.005f : NEAR_Z; // Use closer clip for portals to prevent blinking
+
+    if (!ClipWall(p1_cam, p2_cam, &c1, &c2, &t1_clip, &t2_clip, clip_dist)) {
+        STAT_ADD(ctx, walls_culled, 1);
+        return false;
+    }
+    
+    // 2. Project X
+    f32 x1 = center_x + (c1.y / c1.x) * scale;
+    f32 x2 = center_x + (c2.y / c2.x) * scale;
+    
+    if (x1 >= x2) { // Cull
+        STAT_ADD(ctx, walls_culled, 1);
+        return false;
+    }
+    f32 inv_span = 1.0f / (x2 - x1);
+    
+    // 4. Clip to Window
+    int ix1 = (int)ceilf(x1);
+    int ix2 = (int)ceilf(x2);
+    
+    int draw_x1 = (ix1 < min_x) ? min_x : ix1;
+    int draw_x2 = (ix2 > max_x) ? max_x : ix2;
+    
+    if (draw_x1 >= draw_x2 || IsRangeClosed(ctx, draw_x1, draw_x2)) { // Outside the window or fully occluded
+        STAT_ADD(ctx, walls_culled, 1);
+        return false;
+    }
+    
+    // 5. Calculate Heights
+    f32 ceil_h = sector->ceil_height - cam->pos.z;
+    f32 floor_h = sector->floor_height - cam->pos.z;
+    
+    f32 y1a = center_y - (ceil_h / c1.x) * scale;
+    f32 y1b = center_y - (floor_h / c1.x) * scale;
+    f32 y2a = center_y - (ceil_h / c2.x) * scale;
+    f32 y2b = center_y - (floor_h / c2.x) * scale;
+    
+    f32 iz1 = 1.0f / c1.x;
+    f32 iz2 = 1.0f / c2.x;
+    
+    f32 u_scale = wall->length * 64.0f;
+    f32 u1 = t1_clip * u_scale;
+    f32 u2 = t2_clip * u_scale;
+    
+    f32 uz1 = u1 * iz1;
+    f32 uz2 = u2 * iz2;
+    
+    GameTexture* top_tex = Texture_Get(wall->top_texture_id);
+    GameTexture* bot_tex = Texture_Get(wall->bottom_texture_id);
+    GameTexture* wall_tex = Texture_Get(wall->texture_id);
+    
+    Sector* next_s = portal ? &map->sectors[wall->next_sector] : NULL;
+    
+    // Planes this wall's columns contribute floor/ceiling rows to
+    ReservePlanes(ctx, view);
+    Visplane* ceil_plane = FindPlane(ctx, sector->ceil_height, sector->ceil_tex_id);
+    ceil_plane = CheckPlane(ctx, ceil_plane, draw_x1, draw_x2 - 1);
+    Visplane* floor_plane = FindPlane(ctx, sector->floor_height, sector->floor_tex_id);
+    floor_plane = CheckPlane(ctx, floor_plane, draw_x1, draw_x2 - 1);
+    
+    // Clip window for the sector behind a portal, if it will be walked.
+    // Sectors outside the camera sector's PVS are skipped with their subtree.
+    bool walk = portal && frame->depth < MAX_RECURSION && PVS_IsVisible(map, view->sector, wall->next_sector);
+    i16* next_y_top = NULL;
+    i16* next_y_bot = NULL;
+    if (walk) {
+        AllocClip(ctx, &child->clip, draw_x1, draw_x2);
+        next_y_top = child->clip.top;
+        next_y_bot = child->clip.bot;
+    }
+    
+    // 6. Draw Columns, skipping closed ones
+    int next_closed = FindClosedRange(ctx, draw_x1);
+    ctx->closing_count = 0;
+    for (int x = draw_x1; x < draw_x2; ++x) {
+        if (next_closed < ctx->closed_count && x >= ctx->closed[next_closed].x1) {
+            x = ctx->closed[next_closed++].x2 - 1;
+            continue;
+        }
+        STAT_ADD(ctx, columns_drawn, 1);
         
-        if (draw_x1 >= draw_x2) continue;
+        f32 t_screen = (x - x1) * inv_span;
         
-        // 5. Calculate Heights
-        f32 ceil_h = sector->ceil_height - cam.pos.z;
-        f32 floor_h = sector->floor_height - cam.pos.z;
+        f32 y_ceil_f = y1a + (y2a - y1a) * t_screen;
+        f32 y_floor_f = y1b + (y2b - y1b) * t_screen;
         
-        f32 y1a = center_y - (ceil_h / c1.x) * scale;
-        f32 y1b = center_y - (floor_h / c1.x) * scale;
-        f32 y2a = center_y - (ceil_h / c2.x) * scale;
-        f32 y2b = center_y - (floor_h / c2.x) * scale;
+        // Wall tops round up so the first textured row never starts above
+        // the edge (v >= 0); bottoms truncate so the last one stays inside.
+        int y_ceil = (int)ceilf(y_ceil_f);
+        int y_floor = (int)y_floor_f;
         
-        f32 iz1 = 1.0f / c1.x;
-        f32 iz2 = 1.0f / c2.x;
+        int cy_top = clip->top[x - min_x];
+        int cy_bot = clip->bot[x - min_x];
         
-        f32 u_scale = wall_len * 64.0f;
-        f32 u1 = t1_clip * u_scale;
-        f32 u2 = t2_clip * u_scale;
+        // Ceiling: from top clip down to the row above the wall top
+        MarkPlane(ceil_plane, x, cy_top, min(y_ceil - 1, cy_bot));
+        // Floor: from wall bottom down to bottom clip
+        MarkPlane(floor_plane, x, max(y_floor, cy_top), cy_bot);
         
-        f32 uz1 = u1 * iz1;
-        f32 uz2 = u2 * iz2;
+        f32 iz = iz1 + (iz2 - iz1) * t_screen;
+        f32 uz = uz1 + (uz2 - uz1) * t_screen;
+        int tex_x = (int)(uz / iz);
         
-        // Preparing next recursion buffers if portal
-        // Preparing next recursion buffers if portal
-        i16 next_y_top[MAX_VIDEO_WIDTH];
-        i16 next_y_bot[MAX_VIDEO_WIDTH];
-        // 6. Draw Columns
-        for (int x = draw_x1; x < draw_x2; ++x) {
-            f32 t_screen = (x - x1) / (x2 - x1);
+        if (portal) {
+            f32 n_ceil_h = next_s->ceil_height - cam->pos.z;
+            f32 n_floor_h = next_s->floor_height - cam->pos.z;
             
-            f32 y_ceil_f = y1a + (y2a - y1a) * t_screen;
-            f32 y_floor_f = y1b + (y2b - y1b) * t_screen;
+            f32 ny1a = center_y - (n_ceil_h / c1.x) * scale;
+            f32 ny1b = center_y - (n_floor_h / c1.x) * scale;
+            f32 ny2a = center_y - (n_ceil_h / c2.x) * scale;
+            f32 ny2b = center_y - (n_floor_h / c2.x) * scale;
             
-            int y_ceil = (int)y_ceil_f;
-            int y_floor = (int)y_floor_f;
+            f32 ny_ceil_f = ny1a + (ny2a - ny1a) * t_screen;
+            f32 ny_floor_f = ny1b + (ny2b - ny1b) * t_screen;
             
-            int cy_top = y_top[x];
-            int cy_bot = y_bot[x];
+            int ny_ceil = (int)ny_ceil_f;
+            int ny_floor = (int)ceilf(ny_floor_f);
             
-            // Draw Ceiling (from top clip to wall top)
-            if (y_ceil > cy_top) {
-                DrawFlat(x, cy_top, min(y_ceil, cy_bot), sector->ceil_height - cam.pos.z, cam, ceil_tex);
-            }
-            // Draw Floor (from wall bottom to bot clip)
-            if (y_floor < cy_bot) {
-                DrawFlat(x, max(y_floor, cy_top), cy_bot, cam.pos.z - sector->floor_height, cam, floor_tex);
+            // --- Upper Wall (Transom) ---
+            int u_start = max(y_ceil, cy_top);
+            int u_end = min(ny_ceil - 1, cy_bot);
+            
+            if (u_start <= u_end) {
+                 STAT_ADD(ctx, wall_pixels, u_end - u_start + 1);
+                 if (top_tex) {
+                    f32 world_h = (sector->ceil_height - next_s->ceil_height);
+                    f32 v_scale = world_h * 64.0f;
+                    float pixel_h = ny_ceil_f - y_ceil_f;
+                    float v_s = v_scale / pixel_h;
+                    
+                    Video_DrawTexturedColumn(x, u_start, u_end, top_tex, tex_x, (u_start - y_ceil_f) * v_s, v_s);
+                 } else {
+                     Video_DrawVertLine(x, u_start, u_end, (Color){80, 80, 80, 255});
+                 }
             }
             
-            // Wall / Portal Window
-            GameTexture* top_tex = Texture_Get(wall->top_texture_id);
-            GameTexture* bot_tex = Texture_Get(wall->bottom_texture_id);
-            GameTexture* wall_tex = Texture_Get(wall->texture_id);
-
-            int wy_top = cy_top;
-            int wy_bot = cy_bot;
+            // --- Lower Wall (Step) ---
+            int b_start = max(ny_floor, cy_top);
+            int b_end = min(y_floor - 1, cy_bot);
             
-            if (portal) {
-                Sector* next_s = &map->sectors[wall->next_sector];
-                f32 n_ceil_h = next_s->ceil_height - cam.pos.z;
-                f32 n_floor_h = next_s->floor_height - cam.pos.z;
-                
-                f32 ny1a = center_y - (n_ceil_h / c1.x) * scale;
-                f32 ny1b = center_y - (n_floor_h / c1.x) * scale;
-                f32 ny2a = center_y - (n_ceil_h / c2.x) * scale;
-                f32 ny2b = center_y - (n_floor_h / c2.x) * scale;
-                
-                f32 ny_ceil_f = ny1a + (ny2a - ny1a) * t_screen;
-                f32 ny_floor_f = ny1b + (ny2b - ny1b) * t_screen;
-                
-                int ny_ceil = (int)ny_ceil_f;
-                int ny_floor = (int)ny_floor_f;
-                
-                // --- Upper Wall (Transom) ---
-                int u_start = max(y_ceil, cy_top);
-                int u_end = min(ny_ceil, cy_bot);
-                
-                if (u_start < u_end) {
-                     if (top_tex) {
-                        f32 iz = iz1 + (iz2 - iz1) * t_screen;
-                        f32 uz = uz1 + (uz2 - uz1) * t_screen;
-                        int tex_x = (int)(uz / iz);
-                        
-                        f32 world_h = (sector->ceil_height - next_s->ceil_height);
-                        f32 v_scale = world_h * 64.0f;
-                        float pixel_h = ny_ceil_f - y_ceil_f;
-                        float v_s = v_scale / pixel_h;
-                        
-                        Video_DrawTexturedColumn(x, u_start, u_end - 1, top_tex, tex_x, (u_start - y_ceil_f) * v_s, v_s);
-                     } else {
-                         Video_DrawVertLine(x, u_start, u_end - 1, (Color){80, 80, 80, 255});
-                     }
-                }
-                
-                // --- Lower Wall (Step) ---
-                int b_start = max(ny_floor, cy_top);
-                int b_end = min(y_floor, cy_bot);
-                
-                if (b_start < b_end) {
-                    if (bot_tex) {
-                        f32 iz = iz1 + (iz2 - iz1) * t_screen;
-                        f32 uz = uz1 + (uz2 - uz1) * t_screen;
-                        int tex_x = (int)(uz / iz);
-                        
-                        f32 world_h = (next_s->floor_height - sector->floor_height);
-                        f32 v_scale = world_h * 64.0f;
-                        float pixel_h = y_floor_f - ny_floor_f;
-                        float v_s = v_scale / pixel_h;
-                        
-                        Video_DrawTexturedColumn(x, b_start, b_end - 1, bot_tex, tex_x, (b_start - ny_floor_f) * v_s, v_s);
-                    } else {
-                        Video_DrawVertLine(x, b_start, b_end - 1, (Color){80, 80, 80, 255});
-                    }
-                }
-                
-                // Update Window for Recursion
-                // Clip against Current Sector Ceiling/Floor as well
-                wy_top = max(ny_ceil, max(y_ceil, cy_top));
-                wy_bot = min(ny_floor, min(y_floor, cy_bot));
-                
-            } else {
-                // Not a portal - Draw Solid Wall
-                int w_start = max(y_ceil, cy_top);
-                int w_end = min(y_floor, cy_bot);
-                
-                if (w_start < w_end) {
-                    if (wall_tex) {
-                        f32 iz = iz1 + (iz2 - iz1) * t_screen;
-                        f32 uz = uz1 + (uz2 - uz1) * t_screen;
-                        int tex_x = (int)(uz / iz);
-                        
-                        f32 world_height = sector->ceil_height - sector->floor_height;
-                        float v_scale = world_height * 64.0f;
-                        float height = y_floor_f - y_ceil_f;
-                        float v_step = v_scale / height;
-                        
-                        Video_DrawTexturedColumn(x, w_start, w_end - 1, wall_tex, tex_x, (w_start - y_ceil_f) * v_step, v_step);
-                    } else {
-                        Video_DrawVertLine(x, w_start, w_end - 1, (Color){100, 100, 100, 255});
-                    }
+            if (b_start <= b_end) {
+                STAT_ADD(ctx, wall_pixels, b_end - b_start + 1);
+                if (bot_tex) {
+                    f32 world_h = (next_s->floor_height - sector->floor_height);
+                    f32 v_scale = world_h * 64.0f;
+                    float pixel_h = y_floor_f - ny_floor_f;
+                    float v_s = v_scale / pixel_h;
+                    
+                    Video_DrawTexturedColumn(x, b_start, b_end, bot_tex, tex_x, (b_start - ny_floor_f) * v_s, v_s);
+                } else {
+                    Video_DrawVertLine(x, b_start, b_end, (Color){80, 80, 80, 255});
                 }
             }
             
-            if (wy_top < wy_bot) {
-                if (portal) {
-                    next_y_top[x] = wy_top;
-                    next_y_bot[x] = wy_bot;
+            // Window for Recursion: between the upper and lower walls,
+            // clipped against the current sector's ceiling/floor as well
+            int wy_top = max(ny_ceil, max(y_ceil, cy_top));
+            int wy_bot = min(ny_floor - 1, min(y_floor - 1, cy_bot));
+            
+            // Nothing can be seen through a shut window
+            if (wy_top > wy_bot) MarkClosing(ctx, x);
+            
+            if (walk) {
+                if (wy_top <= wy_bot) {
+                    next_y_top[x - draw_x1] = wy_top;
+                    next_y_bot[x - draw_x1] = wy_bot;
+                } else {
+                    next_y_top[x - draw_x1] = VIDEO_HEIGHT;
+                    next_y_bot[x - draw_x1] = -1;
                 }
-            } else {
-                if (portal) {
-                   next_y_top[x] = VIDEO_HEIGHT;
-                   next_y_bot[x] = -1;
+            }
+            
+        } else {
+            // Not a portal - Draw Solid Wall
+            MarkClosing(ctx, x);
+            
+            int w_start = max(y_ceil, cy_top);
+            int w_end = min(y_floor - 1, cy_bot);
+            
+            if (w_start <= w_end) {
+                STAT_ADD(ctx, wall_pixels, w_end - w_start + 1);
+                if (wall_tex) {
+                    f32 world_height = sector->ceil_height - sector->floor_height;
+                    float v_scale = world_height * 64.0f;
+                    float height = y_floor_f - y_ceil_f;
+                    float v_step = v_scale / height;
+                    
+                    Video_DrawTexturedColumn(x, w_start, w_end, wall_tex, tex_x, (w_start - y_ceil_f) * v_step, v_step);
+                } else {
+                    Video_DrawVertLine(x, w_start, w_end, (Color){100, 100, 100, 255});
                 }
             }
         }
+    }
+    
+    // Columns closed by this wall only matter to what is drawn after it
+    for (int i = 0; i < ctx->closing_count; ++i) {
+        CloseColumns(ctx, ctx->closing[i].x1, ctx->closing[i].x2);
+    }
+    
+    if (!walk) return false;
+    if (IsRangeClosed(ctx, draw_x1, draw_x2)) {
+        ctx->clip_used -= (draw_x2 - draw_x1) * 2; // Release the child's window
+        return false;
+    }
+    
+    child->sector_id = wall->next_sector;
+    child->next_wall = 0;
+    child->depth = frame->depth + 1;
+    return true;
+}
+
+// Walk the portal graph from start_sector over columns [min_x, max_x).
+// Depth-first with an explicit stack: a portal's sector is finished before
+// the next wall of its parent, the same order as a recursive walk.
+// Sectors whose window is fully occluded are dropped, and the walk ends once
+// every column is closed.
+static void RenderPortals(RenderContext* ctx, Map* map, const RenderView* view, SectorID start_sector, int min_x, int max_x) {
+    if (min_x >= max_x) return;
+    
+    ctx->clip_used = 0;
+    ctx->closed_count = 0;
+    ctx->open_columns = max_x - min_x;
+    
+    PortalFrame* root = &ctx->stack[0];
+    root->sector_id = start_sector;
+    root->next_wall = 0;
+    root->depth = 0;
+    AllocClip(ctx, &root->clip, min_x, max_x);
+    for (int i = 0; i < max_x - min_x; ++i) {
+        root->clip.top[i] = 0;
+        root->clip.bot[i] = VIDEO_HEIGHT - 1;
+    }
+    
+    int sp = 1;
+    while (sp > 0 && ctx->open_columns > 0) {
+        PortalFrame* frame = &ctx->stack[sp - 1];
+        Sector* sector = &map->sectors[frame->sector_id];
         
-        if (portal) {
-            RenderSector(map, cam, wall->next_sector, draw_x1, draw_x2, next_y_top, next_y_bot, depth + 1);
+        if (frame->next_wall >= sector->num_walls || IsRangeClosed(ctx, frame->clip.x1, frame->clip.x2)) {
+            // Done with this sector; its window is the newest arena allocation
+            ctx->clip_used = (int)(frame->clip.top - ctx->clip_arena);
+            --sp;
+            continue;
+        }
+        
+        if (frame->next_wall == 0) STAT_ADD(ctx, sectors_visited, 1);
+        
+        WallID wid = sector->first_wall + frame->next_wall++;
+        if (RenderWall(ctx, map, view, frame, wid, &ctx->stack[sp])) {
+            STAT_ADD(ctx, portals_recursed, 1);
+            STAT_MAX(ctx, max_depth, ctx->stack[sp].depth);
+            ++sp;
         }
     }
 }
 
+// Columns are independent once the portal walk is clipped to [min_x, max_x),
+// so the screen is split into vertical bands that each run their own walk.
+// Every column sees the same walls in the same order as a full-width walk,
+// which keeps the threaded output identical to the single-threaded one.
+typedef struct {
+    Map* map;
+    const RenderView* view;
+    SectorID start_sector;
+    int band_count;
+} RenderBandJob;
+
+// One context per band, kept across frames
+static RenderContext* g_contexts[MAX_RENDER_BANDS];
+
+static RenderContext* GetContext(int band) {
+    if (!g_contexts[band]) {
+        g_contexts[band] = (RenderContext*)malloc(sizeof(RenderContext));
+    }
+    return g_contexts[band];
+}
+
+static void RenderBand(RenderContext* ctx, Map* map, const RenderView* view, SectorID start_sector, int min_x, int max_x) {
+    if (!ctx) return;
+    
+    ctx->min_x = min_x;
+    ctx->max_x = max_x;
+    ctx->plane_count = 0;
+#if BOOMER_RENDER_STATS
+    ctx->stats = (RenderStats){0};
+#endif
+    
+    PROFILE_BEGIN("RenderPortals");
+    RenderPortals(ctx, map, view, start_sector, min_x, max_x);
+    PROFILE_END();
+    
+    PROFILE_BEGIN("DrawPlanes");
+    DrawPlanes(ctx, view);
+    PROFILE_END();
+}
+
+static void RenderBandJobFunc(void* user, int index) {
+    RenderBandJob* job = (RenderBandJob*)user;
+    int min_x = (VIDEO_WIDTH * index) / job->band_count;
+    int max_x = (VIDEO_WIDTH * (index + 1)) / job->band_count;
+    RenderBand(GetContext(index), job->map, job->view, job->start_sector, min_x, max_x);
+}
+
+// Add up the bands' counters into g_stats
+static void GatherStats(int bands) {
+#if BOOMER_RENDER_STATS
+    RenderStats sum = {0};
+    for (int i = 0; i < bands; ++i) {
+        if (!g_contexts[i]) continue; // Out of memory, the band was not drawn
+        const RenderStats* s = &g_contexts[i]->stats;
+        sum.sectors_visited += s->sectors_visited;
+        sum.walls_transformed += s->walls_transformed;
+        sum.walls_culled += s->walls_culled;
+        sum.portals_recursed += s->portals_recursed;
+        sum.columns_drawn += s->columns_drawn;
+        sum.wall_pixels += s->wall_pixels;
+        sum.flat_pixels += s->flat_pixels;
+        sum.max_depth = max(sum.max_depth, s->max_depth);
+        sum.plane_flushes += s->plane_flushes;
+    }
+    sum.overdraw = (f32)(sum.wall_pixels + sum.flat_pixels) / (f32)(VIDEO_WIDTH * VIDEO_HEIGHT);
+    g_stats = sum;
+#else
+    (void)bands;
+#endif
+}
+
 void Render_Frame(GameCamera cam, Map* map) {
-    SectorID start_sector = GetSectorAt(map, (Vec2){cam.pos.x, cam.pos.y});
-    if (start_sector == -1) start_sector = 0; 
+    PROFILE_SCOPE("Render_Frame");
+    
+    SectorID cam_sector = TrackSector(map, cam.sector, (Vec2){cam.pos.x, cam.pos.y});
+    SectorID start_sector = (cam_sector == -1) ? 0 : cam_sector;
     
     Video_Clear((Color){20, 20, 30, 255});
     
-    // Init Clipping Buffers
-    // Init Clipping Buffers
-    i16 y_top[MAX_VIDEO_WIDTH];
-    i16 y_bot[MAX_VIDEO_WIDTH];
-    for(int i=0; i<VIDEO_WIDTH; ++i) {
-        y_top[i] = 0;
-        y_bot[i] = VIDEO_HEIGHT - 1;
+    SetupView(&g_view, cam, cam_sector);
+    if (!TransformVertices(&g_view, map)) return;
+    
+    int bands = Jobs_GetThreadCount();
+    if (bands > VIDEO_WIDTH / MIN_BAND_WIDTH) bands = VIDEO_WIDTH / MIN_BAND_WIDTH;
+    if (bands > MAX_RENDER_BANDS) bands = MAX_RENDER_BANDS;
+    
+    if (bands <= 1) {
+        RenderBand(GetContext(0), map, &g_view, start_sector, 0, VIDEO_WIDTH);
+        GatherStats(1);
+        return;
     }
     
-    RenderSector(map, cam, start_sector, 0, VIDEO_WIDTH, y_top, y_bot, 0);
+    RenderBandJob job = {
+        .map = map,
+        .view = &g_view,
+        .start_sector = start_sector,
+        .band_count = bands
+    };
+    Jobs_ParallelFor(bands, RenderBandJobFunc, &job);
+    GatherStats(bands);
 }
 
 void Render_Map2D(Map* map, GameCamera cam, int x, int y, int w, int h, float zoom, int highlight_sector, int highlight_wall_index, int hovered_sector, int hovered_wall_index) {
@@ -390,10 +939,10 @@ void Render_Map2D(Map* map, GameCamera cam, int x, int y, int w, int h, float zo
     for (int i = 0; i < map->wall_count; ++i) {
         Wall* wall = &map->walls[i];
         
-        float x1 = cx + (wall->p1.x - cam.pos.x) * zoom;
-        float y1 = cy - (wall->p1.y - cam.pos.y) * zoom;
-        float x2 = cx + (wall->p2.x - cam.pos.x) * zoom;
-        float y2 = cy - (wall->p2.y - cam.pos.y) * zoom;
+        float x1 = cx + (map->vertex_x[wall->v1] - cam.pos.x) * zoom;
+        float y1 = cy - (map->vertex_y[wall->v1] - cam.pos.y) * zoom;
+        float x2 = cx + (map->vertex_x[wall->v2] - cam.pos.x) * zoom;
+        float y2 = cy - (map->vertex_y[wall->v2] - cam.pos.y) * zoom;
         
         Color col;
         if (wall->next_sector != -1) {
@@ -411,19 +960,17 @@ void Render_Map2D(Map* map, GameCamera cam, int x, int y, int w, int h, float zo
          
          for (u32 i = 0; i < s->num_walls; ++i) {
             Wall* wall = &map->walls[s->first_wall + i];
-            float x1 = cx + (wall->p1.x - cam.pos.x) * zoom;
-            float y1 = cy - (wall->p1.y - cam.pos.y) * zoom;
-            float x2 = cx + (wall->p2.x - cam.pos.x) * zoom;
-            float y2 = cy - (wall->p2.y - cam.pos.y) * zoom;
+            float x1 = cx + (map->vertex_x[wall->v1] - cam.pos.x) * zoom;
+            float y1 = cy - (map->vertex_y[wall->v1] - cam.pos.y) * zoom;
+            float x2 = cx + (map->vertex_x[wall->v2] - cam.pos.x) * zoom;
+            float y2 = cy - (map->vertex_y[wall->v2] - cam.pos.y) * zoom;
             
             DrawLineV((Vector2){x1, y1}, (Vector2){x2, y2}, h_col);
             
-            // Normals (Inward: dy, -dx)
-             float nx = (y2 - y1);
-             float ny = -(x2 - x1);
-             float len = sqrtf(nx*nx + ny*ny);
-             if (len > 0) {
-                 nx /= len; ny /= len;
+            // Normals (Inward)
+             float nx = wall->normal.x;
+             float ny = -wall->normal.y; // Screen y points down
+             if (wall->length > 0) {
                  DrawLineV((Vector2){(x1+x2)/2, (y1+y2)/2}, (Vector2){(x1+x2)/2 + nx*8, (y1+y2)/2 + ny*8}, h_col);
              }
              
@@ -437,10 +984,10 @@ void Render_Map2D(Map* map, GameCamera cam, int x, int y, int w, int h, float zo
         
         for (u32 i = 0; i < s->num_walls; ++i) {
             Wall* wall = &map->walls[s->first_wall + i];
-            float x1 = cx + (wall->p1.x - cam.pos.x) * zoom;
-            float y1 = cy - (wall->p1.y - cam.pos.y) * zoom;
-            float x2 = cx + (wall->p2.x - cam.pos.x) * zoom;
-            float y2 = cy - (wall->p2.y - cam.pos.y) * zoom;
+            float x1 = cx + (map->vertex_x[wall->v1] - cam.pos.x) * zoom;
+            float y1 = cy - (map->vertex_y[wall->v1] - cam.pos.y) * zoom;
+            float x2 = cx + (map->vertex_x[wall->v2] - cam.pos.x) * zoom;
+            float y2 = cy - (map->vertex_y[wall->v2] - cam.pos.y) * zoom;
             
             // Highlight Logic for Walls
             Color w_col;
@@ -458,11 +1005,9 @@ void Render_Map2D(Map* map, GameCamera cam, int x, int y, int w, int h, float zo
             DrawLineV((Vector2){x1, y1}, (Vector2){x2, y2}, w_col);
             
             // Draw Tick Normal (Inward)
-             float nx = (y2 - y1);
-             float ny = -(x2 - x1);
-             float len = sqrtf(nx*nx + ny*ny);
-             if (len > 0) {
-                 nx /= len; ny /= len;
+             float nx = wall->normal.x;
+             float ny = -wall->normal.y; // Screen y points down
+             if (wall->length > 0) {
                  DrawLineV((Vector2){(x1+x2)/2, (y1+y2)/2}, (Vector2){(x1+x2)/2 + nx*8, (y1+y2)/2 + ny*8}, w_col);
              }
              
@@ -7,12 +7,42 @@
 typedef struct GameCamera {
     Vec3 pos;    // x, y, z
     f32  yaw;    // horizontal angle in radians
+    SectorID sector; // Last known sector, -1 if unknown (see TrackSector)
     // f32 pitch; // vertical angle (later)
 } GameCamera;
 
+// Renderer counters are gathered in debug builds only. Release builds
+// (NDEBUG) compile the counting out of the renderer; -DBOOMER_RENDER_STATS=1
+// keeps it.
+#ifndef BOOMER_RENDER_STATS
+#ifdef NDEBUG
+#define BOOMER_RENDER_STATS 0
+#else
+#define BOOMER_RENDER_STATS 1
+#endif
+#endif
+
+// What the last Render_Frame did. Bands walk the portal graph separately,
+// so walk counters are totals over all bands.
+typedef struct RenderStats {
+    u32 sectors_visited;    // Sectors whose walls were processed
+    u32 walls_transformed;  // Walls processed (end points taken from the camera-space vertex cache)
+    u32 walls_culled;       // Of those, back-facing, behind the camera, outside the window or occluded
+    u32 portals_recursed;   // Portals walked through into the next sector
+    u32 columns_drawn;      // Wall columns drawn (not skipped as occluded)
+    u32 wall_pixels;        // Pixels written by wall columns
+    u32 flat_pixels;        // Pixels written by floor/ceiling spans
+    u32 max_depth;          // Deepest portal recursion reached
+    u32 plane_flushes;      // Times a band ran out of visplanes and drew them early
+    f32 overdraw;           // (wall_pixels + flat_pixels) / screen pixels
+} RenderStats;
+
 // Initialize renderer resources
 void Renderer_Init(void);
 
+// Counters of the last frame. All zero when BOOMER_RENDER_STATS is 0.
+const RenderStats* Render_GetStats(void);
+
 // Project world space vertex to screen space
 // Returns true if the vertex is behind the camera (and should be clipped/ignored)
 bool WorldToScreen(Vec3 world_pos, GameCamera cam, Vec2* screen_out);
@@ -0,0 +1,168 @@
+#include "perf_overlay.h"
+#include "../core/cache.h"
+#include "../core/clock.h"
+#include "../core/profiler.h"
+#include "../core/script_sys.h"
+#include "../render/renderer.h"
+#include "../video/video.h"
+
+#define PERF_HISTORY 128        // Frames in the graph
+#define PERF_GRAPH_MAX_MS 50.0f // Frame time at the top of the graph
+#define PERF_MARGIN 4
+
+static struct {
+    bool visible;
+    f32 frame_ms[PERF_HISTORY]; // Ring buffer of frame times
+    int head;                   // Index of next write
+    int count;
+    f64 last_time;
+} perf = {0};
+
+// --- JS Bindings ---
+
+// {sectorsVisited, ...} = Perf.GetRenderStats(), null if counters are compiled out
+static JSValue js_Perf_GetRenderStats(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    (void)this_val; (void)argc; (void)argv;
+#if BOOMER_RENDER_STATS
+    const RenderStats* s = Render_GetStats();
+    JSValue obj = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, obj, "sectorsVisited", JS_NewInt64(ctx, s->sectors_visited));
+    JS_SetPropertyStr(ctx, obj, "wallsTransformed", JS_NewInt64(ctx, s->walls_transformed));
+    JS_SetPropertyStr(ctx, obj, "wallsCulled", JS_NewInt64(ctx, s->walls_culled));
+    JS_SetPropertyStr(ctx, obj, "portalsRecursed", JS_NewInt64(ctx, s->portals_recursed));
+    JS_SetPropertyStr(ctx, obj, "columnsDrawn", JS_NewInt64(ctx, s->columns_drawn));
+    JS_SetPropertyStr(ctx, obj, "wallPixels", JS_NewInt64(ctx, s->wall_pixels));
+    JS_SetPropertyStr(ctx, obj, "flatPixels", JS_NewInt64(ctx, s->flat_pixels));
+    JS_SetPropertyStr(ctx, obj, "maxDepth", JS_NewInt64(ctx, s->max_depth));
+    JS_SetPropertyStr(ctx, obj, "planeFlushes", JS_NewInt64(ctx, s->plane_flushes));
+    JS_SetPropertyStr(ctx, obj, "overdraw", JS_NewFloat64(ctx, s->overdraw));
+    return obj;
+#else
+    (void)ctx;
+    return JS_NULL;
+#endif
+}
+
+// {hits, misses, evictions, bytes, budget, entries} = Perf.GetCacheStats()
+static JSValue js_Perf_GetCacheStats(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    (void)this_val; (void)argc; (void)argv;
+    CacheStats s;
+    Cache_GetStats(&s);
+    JSValue obj = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, obj, "hits", JS_NewInt64(ctx, (int64_t)s.hits));
+    JS_SetPropertyStr(ctx, obj, "misses", JS_NewInt64(ctx, (int64_t)s.misses));
+    JS_SetPropertyStr(ctx, obj, "evictions", JS_NewInt64(ctx, (int64_t)s.evictions));
+    JS_SetPropertyStr(ctx, obj, "bytes", JS_NewInt64(ctx, (int64_t)s.bytes));
+    JS_SetPropertyStr(ctx, obj, "budget", JS_NewInt64(ctx, (int64_t)s.budget));
+    JS_SetPropertyStr(ctx, obj, "entries", JS_NewInt64(ctx, s.entries));
+    return obj;
+}
+
+// Perf.SetOverlay(on)
+static JSValue js_Perf_SetOverlay(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    (void)this_val;
+    if (argc < 1) return JS_EXCEPTION;
+
+    int on = JS_ToBool(ctx, argv[0]);
+    if (on < 0) return JS_EXCEPTION;
+
+    PerfOverlay_SetVisible(on);
+    return JS_UNDEFINED;
+}
+
+// bool = Perf.IsOverlayVisible()
+static JSValue js_Perf_IsOverlayVisible(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    (void)this_val; (void)argc; (void)argv;
+    return JS_NewBool(ctx, perf.visible);
+}
+
+// bool = Perf.DumpTrace([filename]), writes a Chrome trace to user data
+static JSValue js_Perf_DumpTrace(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    (void)this_val;
+    if (argc < 1) return JS_NewBool(ctx, Profile_DumpTrace("trace.json"));
+
+    const char* filename = JS_ToCString(ctx, argv[0]);
+    if (!filename) return JS_EXCEPTION;
+
+    bool ok = Profile_DumpTrace(filename);
+    JS_FreeCString(ctx, filename);
+    return JS_NewBool(ctx, ok);
+}
+
+void PerfOverlay_Init(void) {
+    JSContext* ctx = Script_GetContext();
+    if (!ctx) return;
+
+    JSValue global_obj = JS_GetGlobalObject(ctx);
+    JSValue perf_obj = JS_NewObject(ctx);
+
+    JS_SetPropertyStr(ctx, perf_obj, "GetRenderStats", JS_NewCFunction(ctx, js_Perf_GetRenderStats, "GetRenderStats", 0));
+    JS_SetPropertyStr(ctx, perf_obj, "GetCacheStats", JS_NewCFunction(ctx, js_Perf_GetCacheStats, "GetCacheStats", 0));
+    JS_SetPropertyStr(ctx, perf_obj, "SetOverlay", JS_NewCFunction(ctx, js_Perf_SetOverlay, "SetOverlay", 1));
+    JS_SetPropertyStr(ctx, perf_obj, "IsOverlayVisible", JS_NewCFunction(ctx, js_Perf_IsOverlayVisible, "IsOverlayVisible", 0));
+    JS_SetPropertyStr(ctx, perf_obj, "DumpTrace", JS_NewCFunction(ctx, js_Perf_DumpTrace, "DumpTrace", 1));
+
+    JS_SetPropertyStr(ctx, global_obj, "Perf", perf_obj);
+    JS_FreeValue(ctx, global_obj);
+}
+
+void PerfOverlay_Toggle(void) {
+    perf.visible = !perf.visible;
+}
+
+void PerfOverlay_SetVisible(bool visible) {
+    perf.visible = visible;
+}
+
+bool PerfOverlay_IsVisible(void) {
+    return perf.visible;
+}
+
+static Color BarColor(f32 ms) {
+    if (ms <= 1000.0f / 60.0f) return (Color){60, 200, 60, 255};
+    if (ms <= 1000.0f / 30.0f) return (Color){230, 200, 40, 255};
+    return (Color){220, 50, 50, 255};
+}
+
+void PerfOverlay_Draw(void) {
+    f64 now = Clock_Now();
+    if (perf.last_time > 0) {
+        perf.frame_ms[perf.head] = (f32)((now - perf.last_time) * 1000.0);
+        perf.head = (perf.head + 1) % PERF_HISTORY;
+        if (perf.count < PERF_HISTORY) perf.count++;
+    }
+    perf.last_time = now;
+
+    if (!perf.visible) return;
+
+    int w = VIDEO_WIDTH - PERF_MARGIN * 2;
+    if (w > PERF_HISTORY) w = PERF_HISTORY;
+    int h = VIDEO_HEIGHT / 4;
+    if (w <= 0 || h <= 0) return;
+
+    int x0 = PERF_MARGIN;
+    int y0 = VIDEO_HEIGHT - PERF_MARGIN - h;
+    int base = y0 + h - 1;
+
+    // Darken the background so the bars read over any scene
+    for (int y = y0; y <= base; ++y) {
+        u32* row = &video_pixels[y * VIDEO_WIDTH + x0];
+        for (int x = 0; x < w; ++x) {
+            row[x] = ((row[x] >> 1) & 0x007F7F7F) | 0xFF000000;
+        }
+    }
+
+    // Newest frame on the right
+    for (int i = 0; i < w && i < perf.count; ++i) {
+        int slot = (perf.head - 1 - i + PERF_HISTORY) % PERF_HISTORY;
+        f32 ms = perf.frame_ms[slot];
+        int bar = (int)(ms / PERF_GRAPH_MAX_MS * h);
+        if (bar > h) bar = h;
+        if (bar < 1) bar = 1;
+        Video_DrawVertLine(x0 + w - 1 - i, base - bar + 1, base, BarColor(ms));
+    }
+
+    // 60 and 30 fps budgets
+    Video_DrawHorizLine(base - (int)(1000.0f / 60.0f / PERF_GRAPH_MAX_MS * h), x0, x0 + w - 1, (Color){255, 255, 255, 255});
+    Video_DrawHorizLine(base - (int)(1000.0f / 30.0f / PERF_GRAPH_MAX_MS * h), x0, x0 + w - 1, (Color){160, 160, 160, 255});
+}
@@ -0,0 +1,21 @@
+#ifndef BOOMER_PERF_OVERLAY_H
+#define BOOMER_PERF_OVERLAY_H
+
+#include "../core/types.h"
+#include <stdbool.h>
+
+// Frame-time graph drawn in software into video_pixels (bottom-left corner),
+// so it shows up in window scaling, headless frame dumps and the editor view.
+// Registers the script API: Perf.GetRenderStats(), Perf.SetOverlay(on),
+// Perf.IsOverlayVisible(), Perf.DumpTrace([filename]).
+void PerfOverlay_Init(void);
+
+void PerfOverlay_Toggle(void);
+void PerfOverlay_SetVisible(bool visible);
+bool PerfOverlay_IsVisible(void);
+
+// Call once per frame after the scene is rendered, before Video_DrawGame.
+// Frame time is recorded even while hidden, so the graph is full when shown.
+void PerfOverlay_Draw(void);
+
+#endif // BOOMER_PERF_OVERLAY_H
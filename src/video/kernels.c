@@ -0,0 +1,199 @@
+#include "kernels.h"
+#include <stdio.h>
+
+// SIMD versions need GCC/Clang function target attributes and are x86-64 only.
+// Configure with -DBOOMER_SIMD=OFF (defines BOOMER_NO_SIMD) to build scalar only.
+#if !defined(BOOMER_NO_SIMD) && defined(__x86_64__) && defined(__GNUC__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// --- Scalar ---
+
+static void Fill_Scalar(u32* dst, int count, u32 color) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+
+// Column kernels are bound by their strided stores; gathering the texels
+// 8 at a time measured no faster, so every set uses the scalar versions.
+static void FillColumn_Scalar(u32* dst, int count, int stride, u32 color) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        dst[0] = color;
+        dst[stride] = color;
+        dst[stride * 2] = color;
+        dst[stride * 3] = color;
+        dst += stride * 4;
+    }
+    for (; i < count; ++i) {
+        *dst = color;
+        dst += stride;
+    }
+}
+
+static void ColumnPow2_Scalar(u32* dst, int count, int stride, const u32* col, u32 v, u32 step, u32 mask) {
+    for (int i = 0; i < count; ++i) {
+        *dst = col[(v >> 16) & mask];
+        dst += stride;
+        v += step;
+    }
+}
+
+static void SpanPow2_Scalar(u32* dst, int count, const u32* tex, u32 u, u32 v, u32 du, u32 dv,
+                            u32 wmask, u32 hmask, u32 wshift) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = tex[(((v >> 16) & hmask) << wshift) | ((u >> 16) & wmask)];
+        u += du;
+        v += dv;
+    }
+}
+
+static const PixelKernels g_scalar_kernels = {
+    "scalar", Fill_Scalar, FillColumn_Scalar, ColumnPow2_Scalar, SpanPow2_Scalar
+};
+
+#ifdef KERNELS_X86
+
+// --- SSE2 (baseline on x86-64) ---
+
+static void Fill_SSE2(u32* dst, int count, u32 color) {
+    __m128i c = _mm_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm_storeu_si128((__m128i*)(dst + i), c);
+        _mm_storeu_si128((__m128i*)(dst + i + 4), c);
+        _mm_storeu_si128((__m128i*)(dst + i + 8), c);
+        _mm_storeu_si128((__m128i*)(dst + i + 12), c);
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), c);
+    }
+    for (; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+
+// SSE2 has no gather: texel addresses for 4 pixels are computed at once,
+// the loads are scalar and the 4 texels go out in one store.
+static void SpanPow2_SSE2(u32* dst, int count, const u32* tex, u32 u, u32 v, u32 du, u32 dv,
+                          u32 wmask, u32 hmask, u32 wshift) {
+    int i = 0;
+    if (count >= 4) {
+        __m128i vu = _mm_setr_epi32((int)u, (int)(u + du), (int)(u + du * 2), (int)(u + du * 3));
+        __m128i vv = _mm_setr_epi32((int)v, (int)(v + dv), (int)(v + dv * 2), (int)(v + dv * 3));
+        __m128i step_u = _mm_set1_epi32((int)(du * 4));
+        __m128i step_v = _mm_set1_epi32((int)(dv * 4));
+        __m128i mu = _mm_set1_epi32((int)wmask);
+        __m128i mv = _mm_set1_epi32((int)hmask);
+        __m128i shift = _mm_cvtsi32_si128((int)wshift);
+        u32 idx[4];
+
+        for (; i + 4 <= count; i += 4) {
+            __m128i tu = _mm_and_si128(_mm_srli_epi32(vu, 16), mu);
+            __m128i tv = _mm_and_si128(_mm_srli_epi32(vv, 16), mv);
+            _mm_storeu_si128((__m128i*)idx, _mm_or_si128(_mm_sll_epi32(tv, shift), tu));
+            _mm_storeu_si128((__m128i*)(dst + i),
+                             _mm_setr_epi32((int)tex[idx[0]], (int)tex[idx[1]], (int)tex[idx[2]], (int)tex[idx[3]]));
+            vu = _mm_add_epi32(vu, step_u);
+            vv = _mm_add_epi32(vv, step_v);
+        }
+        u += du * (u32)i;
+        v += dv * (u32)i;
+    }
+    SpanPow2_Scalar(dst + i, count - i, tex, u, v, du, dv, wmask, hmask, wshift);
+}
+
+static const PixelKernels g_sse2_kernels = {
+    "sse2", Fill_SSE2, FillColumn_Scalar, ColumnPow2_Scalar, SpanPow2_SSE2
+};
+
+// --- AVX2 ---
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static void Fill_AVX2(u32* dst, int count, u32 color) {
+    __m256i c = _mm256_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        _mm256_storeu_si256((__m256i*)(dst + i), c);
+        _mm256_storeu_si256((__m256i*)(dst + i + 8), c);
+        _mm256_storeu_si256((__m256i*)(dst + i + 16), c);
+        _mm256_storeu_si256((__m256i*)(dst + i + 24), c);
+    }
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i*)(dst + i), c);
+    }
+    for (; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+
+// Lanes start at base, base + step, ... base + 7 * step (wrapping u32 math)
+AVX2 static __m256i Lanes8(u32 base, u32 step) {
+    return _mm256_setr_epi32((int)base, (int)(base + step), (int)(base + step * 2), (int)(base + step * 3),
+                             (int)(base + step * 4), (int)(base + step * 5), (int)(base + step * 6), (int)(base + step * 7));
+}
+
+AVX2 static void SpanPow2_AVX2(u32* dst, int count, const u32* tex, u32 u, u32 v, u32 du, u32 dv,
+                               u32 wmask, u32 hmask, u32 wshift) {
+    int i = 0;
+    if (count >= 8) {
+        __m256i vu = Lanes8(u, du);
+        __m256i vv = Lanes8(v, dv);
+        __m256i step_u = _mm256_set1_epi32((int)(du * 8));
+        __m256i step_v = _mm256_set1_epi32((int)(dv * 8));
+        __m256i mu = _mm256_set1_epi32((int)wmask);
+        __m256i mv = _mm256_set1_epi32((int)hmask);
+        __m128i shift = _mm_cvtsi32_si128((int)wshift);
+
+        for (; i + 8 <= count; i += 8) {
+            __m256i tu = _mm256_and_si256(_mm256_srli_epi32(vu, 16), mu);
+            __m256i tv = _mm256_and_si256(_mm256_srli_epi32(vv, 16), mv);
+            __m256i idx = _mm256_or_si256(_mm256_sll_epi32(tv, shift), tu);
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_i32gather_epi32((const int*)tex, idx, 4));
+            vu = _mm256_add_epi32(vu, step_u);
+            vv = _mm256_add_epi32(vv, step_v);
+        }
+        u += du * (u32)i;
+        v += dv * (u32)i;
+    }
+    SpanPow2_Scalar(dst + i, count - i, tex, u, v, du, dv, wmask, hmask, wshift);
+}
+
+static const PixelKernels g_avx2_kernels = {
+    "avx2", Fill_AVX2, FillColumn_Scalar, ColumnPow2_Scalar, SpanPow2_AVX2
+};
+
+#endif // KERNELS_X86
+
+const PixelKernels* g_pixel_kernels = &g_scalar_kernels;
+
+const PixelKernels* Kernels_Get(KernelLevel level) {
+    switch (level) {
+        case KERNELS_SCALAR:
+            return &g_scalar_kernels;
+#ifdef KERNELS_X86
+        case KERNELS_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2") ? &g_sse2_kernels : NULL;
+        case KERNELS_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? &g_avx2_kernels : NULL;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+void Kernels_Init(void) {
+    for (int level = KERNELS_LEVEL_COUNT - 1; level >= 0; --level) {
+        const PixelKernels* k = Kernels_Get((KernelLevel)level);
+        if (k) {
+            g_pixel_kernels = k;
+            break;
+        }
+    }
+    printf("Video: Using %s pixel kernels\n", g_pixel_kernels->name);
+}
@@ -0,0 +1,46 @@
+#ifndef BOOMER_KERNELS_H
+#define BOOMER_KERNELS_H
+
+#include "../core/types.h"
+
+// Inner loops of the software rasterizer. Every kernel has a portable scalar
+// version; on x86-64 (GCC/Clang) SSE2 and AVX2 versions are compiled in as
+// well and Kernels_Init picks the best one the CPU supports.
+// All versions produce bit-identical output.
+
+typedef enum {
+    KERNELS_SCALAR = 0,
+    KERNELS_SSE2,
+    KERNELS_AVX2,
+    KERNELS_LEVEL_COUNT
+} KernelLevel;
+
+typedef struct PixelKernels {
+    const char* name;
+
+    // dst[0..count) = color
+    void (*fill)(u32* dst, int count, u32 color);
+
+    // dst[i * stride] = color for i in [0, count)
+    void (*fill_column)(u32* dst, int count, int stride, u32 color);
+
+    // Power-of-two textured column. v/step are 16.16 and wrap freely:
+    // dst[i * stride] = col[((v + i * step) >> 16) & mask]
+    void (*column_pow2)(u32* dst, int count, int stride, const u32* col, u32 v, u32 step, u32 mask);
+
+    // Power-of-two textured span over a row-major texture. u/v/du/dv are 16.16:
+    // dst[i] = tex[(((v >> 16) & hmask) << wshift) | ((u >> 16) & wmask)]
+    void (*span_pow2)(u32* dst, int count, const u32* tex, u32 u, u32 v, u32 du, u32 dv,
+                      u32 wmask, u32 hmask, u32 wshift);
+} PixelKernels;
+
+// Kernels used by the video module. Starts out as the scalar set.
+extern const PixelKernels* g_pixel_kernels;
+
+// Detect CPU features and select the fastest supported kernel set
+void Kernels_Init(void);
+
+// Kernel set for a level, or NULL if it is not compiled in or the CPU lacks it
+const PixelKernels* Kernels_Get(KernelLevel level);
+
+#endif // BOOMER_KERNELS_H
@@ -1,11 +1,14 @@
 #include "texture.h"
 #include "../core/fs.h"
+#include "../core/jobs.h"
+#include "../core/profiler.h"
 #include "raylib.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define MAX_TEXTURES 256
+#define TEXTURE_MAX_MIPS 8
 
 typedef struct {
     char name[64];
@@ -15,6 +18,10 @@ typedef struct {
 
 static TextureSlot g_textures[MAX_TEXTURES];
 
+// Guards names and slot claims. The map loader thread looks textures up by
+// name; everything else about the table is only touched on the main thread.
+static JobMutex g_table_lock = JOB_MUTEX_INIT;
+
 void Texture_Init(void) {
     memset(g_textures, 0, sizeof(g_textures));
 }
@@ -22,38 +29,127 @@ void Texture_Init(void) {
 void Texture_Shutdown(void) {
     for (int i = 0; i < MAX_TEXTURES; ++i) {
         if (g_textures[i].active && g_textures[i].tex.pixels) {
-            MemFree(g_textures[i].tex.pixels); // Raylib allocator
-            g_textures[i].tex.pixels = NULL;
+            Texture_FreeDecoded(&g_textures[i].tex);
             g_textures[i].active = false;
         }
     }
 }
 
-TextureID Texture_Load(const char* path) {
-    // 1. Check if already loaded
-    TextureID existing = Texture_GetID(path);
-    if (existing != -1) return existing;
+void Texture_FreeDecoded(GameTexture* tex) {
+    for (u32 m = 0; m + 1 < tex->mip_count; ++m) {
+        free(tex->mips[m].pixels);
+        free(tex->mips[m].columns);
+    }
+    free(tex->mips);
     
-    // 2. Find empty slot
-    int slot = -1;
-    for (int i = 0; i < MAX_TEXTURES; ++i) {
-        if (!g_textures[i].active) {
-            slot = i;
+    MemFree(tex->pixels); // Raylib allocator
+    free(tex->columns);
+    memset(tex, 0, sizeof(*tex));
+}
+
+// Returns log2(v) if v is a power of two, else -1
+static int Log2Exact(u32 v) {
+    if (v == 0 || (v & (v - 1)) != 0) return -1;
+    int shift = 0;
+    while ((1u << shift) != v) ++shift;
+    return shift;
+}
+
+// Build the column-major copy and power-of-two descriptor from pixels
+static bool PrepareTexture(GameTexture* tex) {
+    u32 w = tex->width;
+    u32 h = tex->height;
+    
+    tex->columns = (u32*)malloc(sizeof(u32) * w * h);
+    if (!tex->columns) return false;
+    
+    for (u32 y = 0; y < h; ++y) {
+        const u32* row = &tex->pixels[y * w];
+        for (u32 x = 0; x < w; ++x) {
+            tex->columns[x * h + y] = row[x];
+        }
+    }
+    
+    int ws = Log2Exact(w);
+    int hs = Log2Exact(h);
+    tex->pow2 = (ws >= 0 && hs >= 0);
+    tex->width_shift = (ws >= 0) ? (u32)ws : 0;
+    tex->height_shift = (hs >= 0) ? (u32)hs : 0;
+    tex->width_mask = w - 1;
+    tex->height_mask = h - 1;
+    
+    return true;
+}
+
+// Box-filter src down to half size into dst (dst->width/height already set).
+// A side that is already 1 texel wide is filtered against itself.
+static void Downsample(const GameTexture* src, GameTexture* dst) {
+    u32 dx = (src->width > 1) ? 1 : 0;
+    u32 dy = (src->height > 1) ? 1 : 0;
+    for (u32 y = 0; y < dst->height; ++y) {
+        const u32* r0 = &src->pixels[(y << dy) * src->width];
+        const u32* r1 = &src->pixels[((y << dy) + dy) * src->width];
+        for (u32 x = 0; x < dst->width; ++x) {
+            u32 sx = x << dx;
+            u32 a = r0[sx], b = r0[sx + dx], c = r1[sx], d = r1[sx + dx];
+            u32 out = 0;
+            for (u32 shift = 0; shift < 32; shift += 8) {
+                u32 sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) +
+                          ((c >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+                out |= ((sum + 2) / 4) << shift;
+            }
+            dst->pixels[y * dst->width + x] = out;
+        }
+    }
+}
+
+// Build the mip chain below level 0. Failure just leaves a shorter chain.
+static void BuildMipChain(GameTexture* tex) {
+    tex->mip_count = 1;
+    tex->mips = (GameTexture*)calloc(TEXTURE_MAX_MIPS - 1, sizeof(GameTexture));
+    if (!tex->mips) return;
+    
+    const GameTexture* prev = tex;
+    while (tex->mip_count < TEXTURE_MAX_MIPS) {
+        // Only halve sides that divide exactly so each level tiles like the original
+        if (prev->width == 1 && prev->height == 1) break;
+        if ((prev->width > 1 && (prev->width & 1)) || (prev->height > 1 && (prev->height & 1))) break;
+        
+        GameTexture* mip = &tex->mips[tex->mip_count - 1];
+        mip->width = (prev->width > 1) ? prev->width / 2 : 1;
+        mip->height = (prev->height > 1) ? prev->height / 2 : 1;
+        mip->channels = 4;
+        mip->mip_count = 1;
+        mip->pixels = (u32*)malloc(sizeof(u32) * mip->width * mip->height);
+        if (!mip->pixels) break;
+        
+        Downsample(prev, mip);
+        
+        if (!PrepareTexture(mip)) {
+            free(mip->pixels);
+            mip->pixels = NULL;
             break;
         }
+        
+        tex->mip_count++;
+        prev = mip;
     }
     
-    if (slot == -1) {
-        printf("Texture: Max textures reached!\n");
-        return -1;
+    if (tex->mip_count == 1) {
+        free(tex->mips);
+        tex->mips = NULL;
     }
+}
+
+bool Texture_Decode(const char* path, GameTexture* out) {
+    PROFILE_SCOPE("Texture_Decode"); // Read and decode
+    memset(out, 0, sizeof(*out));
     
-    // 3. Load from FS
-    size_t size;
-    void* data = FS_ReadFile(path, &size);
-    if (!data) {
+    // 1. Map from FS, the decoder only reads it
+    FSMapping file;
+    if (!FS_MapFile(path, &file)) {
         // printf("Texture: Failed to read file '%s'\n", path);
-        return -1;
+        return false;
     }
     
     // Use Raylib to load image from memory
@@ -61,12 +157,12 @@ TextureID Texture_Load(const char* path) {
     const char* ext = strrchr(path, '.');
     if (!ext) ext = ".png"; // default
     
-    Image img = LoadImageFromMemory(ext, data, (int)size);
-    FS_FreeFile(data);
+    Image img = LoadImageFromMemory(ext, (const unsigned char*)file.data, (int)file.size);
+    FS_UnmapFile(&file);
     
     if (img.data == NULL) {
         printf("Texture: Raylib failed to load '%s'\n", path);
-        return -1;
+        return false;
     }
     
     // Ensure RGBA 32 bit
@@ -74,23 +170,71 @@ TextureID Texture_Load(const char* path) {
         ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
     }
     
-    // 4. Store
-    TextureSlot* s = &g_textures[slot];
-    strncpy(s->name, path, sizeof(s->name) - 1);
-    s->tex.width = (u32)img.width;
-    s->tex.height = (u32)img.height;
-    s->tex.channels = 4;
-    s->tex.pixels = (u32*)img.data; // We take ownership of img.data
-    s->active = true;
+    // 2. Derived data
+    out->width = (u32)img.width;
+    out->height = (u32)img.height;
+    out->channels = 4;
+    out->pixels = (u32*)img.data; // We take ownership of img.data
+    
+    if (!PrepareTexture(out)) {
+        printf("Texture: Out of memory preparing '%s'\n", path);
+        MemFree(out->pixels);
+        out->pixels = NULL;
+        return false;
+    }
+    BuildMipChain(out);
     
     // Note: We do NOT UnloadImage(img) because we stole the pointer img.data
     // Raylib's UnloadImage simply frees img.data.
     // We will free it in Texture_Shutdown.
+    return true;
+}
+
+TextureID Texture_Add(const char* path, GameTexture* tex) {
+    Jobs_Lock(&g_table_lock);
+    
+    // 1. Someone else may have loaded it in the meantime
+    int slot = -1;
+    for (int i = 0; i < MAX_TEXTURES; ++i) {
+        if (g_textures[i].active && strncmp(g_textures[i].name, path, 64) == 0) {
+            Jobs_Unlock(&g_table_lock);
+            Texture_FreeDecoded(tex);
+            return i;
+        }
+        if (slot == -1 && !g_textures[i].active) slot = i;
+    }
+    
+    // 2. Find empty slot
+    if (slot == -1) {
+        Jobs_Unlock(&g_table_lock);
+        printf("Texture: Max textures reached!\n");
+        Texture_FreeDecoded(tex);
+        return -1;
+    }
+    
+    // 3. Store
+    TextureSlot* s = &g_textures[slot];
+    memset(s->name, 0, sizeof(s->name));
+    strncpy(s->name, path, sizeof(s->name) - 1);
+    s->tex = *tex;
+    s->active = true;
+    Jobs_Unlock(&g_table_lock);
     
-    printf("Texture: Loaded '%s' (%dx%d)\n", path, img.width, img.height);
+    printf("Texture: Loaded '%s' (%ux%u, %u mips%s)\n", path, tex->width, tex->height, tex->mip_count, tex->pow2 ? "" : ", non power-of-two");
+    memset(tex, 0, sizeof(*tex));
     return slot;
 }
 
+TextureID Texture_Load(const char* path) {
+    // Check if already loaded
+    TextureID existing = Texture_GetID(path);
+    if (existing != -1) return existing;
+    
+    GameTexture tex;
+    if (!Texture_Decode(path, &tex)) return -1;
+    return Texture_Add(path, &tex);
+}
+
 GameTexture* Texture_Get(TextureID id) {
     if (id < 0 || id >= MAX_TEXTURES) return NULL;
     if (!g_textures[id].active) return NULL;
@@ -98,12 +242,16 @@ GameTexture* Texture_Get(TextureID id) {
 }
 
 TextureID Texture_GetID(const char* name) {
+    TextureID id = -1;
+    Jobs_Lock(&g_table_lock);
     for (int i = 0; i < MAX_TEXTURES; ++i) {
         if (g_textures[i].active && strncmp(g_textures[i].name, name, 64) == 0) {
-            return i;
+            id = i;
+            break;
         }
     }
-    return -1;
+    Jobs_Unlock(&g_table_lock);
+    return id;
 }
 
 const char* Texture_GetName(TextureID id) {
@@ -8,7 +8,20 @@ typedef i32 TextureID;
 typedef struct GameTexture {
     u32 width, height;
     u32 channels;
-    u32* pixels; // ABGR/ARGB buffer
+    u32* pixels;  // ABGR/ARGB buffer, row-major
+    u32* columns; // Same texels column-major (columns[x * height + y]) for wall columns
+    
+    // Power-of-two descriptor. When pow2 is set, coordinates wrap with
+    // "& mask" and rows/columns are indexed with "<< shift".
+    bool pow2;
+    u32 width_mask, height_mask;
+    u32 width_shift, height_shift;
+    
+    // Mip chain: mips[i] is level i + 1, each half the size of the one above.
+    // The chain stops at 1x1 or when a side can no longer be halved exactly,
+    // so every level still tiles seamlessly.
+    u32 mip_count; // Levels including this one (>= 1)
+    struct GameTexture* mips;
 } GameTexture;
 
 // Initialize Texture Manager
@@ -19,9 +32,33 @@ void Texture_Shutdown(void);
 // Returns -1 on failure.
 TextureID Texture_Load(const char* path);
 
+// Texture_Load in two halves, so the slow part can run off the main thread.
+// Texture_Decode reads and decodes path into out without touching the
+// texture table; it is safe on any thread, as is Texture_GetID.
+// Texture_Add then registers the result on the main thread and takes
+// ownership of it (out is cleared). If path got loaded in the meantime the
+// decoded copy is freed and the existing ID returned.
+bool Texture_Decode(const char* path, GameTexture* out);
+TextureID Texture_Add(const char* path, GameTexture* tex);
+
+// Free a decoded texture that was never passed to Texture_Add
+void Texture_FreeDecoded(GameTexture* tex);
+
 // Get Texture by ID
 GameTexture* Texture_Get(TextureID id);
 
+// Pick the mip level for a texel density (texels per screen pixel).
+// Coordinates for the returned level are divided by 1 << *level_out.
+static inline GameTexture* Texture_SelectMip(GameTexture* tex, f32 texels_per_pixel, u32* level_out) {
+    u32 level = 0;
+    while (texels_per_pixel >= 2.0f && level + 1 < tex->mip_count) {
+        texels_per_pixel *= 0.5f;
+        level++;
+    }
+    *level_out = level;
+    return (level == 0) ? tex : &tex->mips[level - 1];
+}
+
 // Get Texture ID by name (path) if loaded, else -1
 TextureID Texture_GetID(const char* name);
 
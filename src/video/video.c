@@ -1,8 +1,12 @@
 #include "video.h"
 #include "texture.h"
+#include "kernels.h"
+#include "../core/profiler.h"
 #include "raylib.h"
 #include <stdio.h>
 #include <stdlib.h> // abs
+#include <string.h>
+#include <math.h>
 
 // Exposed buffer
 static u32* frame_buffer = NULL;
@@ -15,23 +19,169 @@ int VIDEO_HEIGHT = 180;
 static int current_scale = 4;
 static bool is_fullscreen = false;
 
+// Logical resolution, the size the game is shown at. The framebuffer and
+// screen texture have this size; frames may render into less of it.
+static int display_width = 320;
+static int display_height = 180;
+
+// Dynamic resolution
+#define DYNRES_STEP 0.125f          // Render scale levels are max_scale - n * step
+#define DYNRES_SMOOTHING 0.1f       // Weight of the newest frame in the average
+#define DYNRES_SETTLE_FRAMES 30     // Frames after a change before the next one
+#define DYNRES_HEADROOM 0.9f        // Step up only if predicted to fit this share of the target
+
+static struct {
+    bool enabled;
+    f32 target_ms;
+    f32 min_scale, max_scale;
+    f32 scale;      // Current render scale
+    f32 avg_ms;     // Smoothed frame time, 0 until the first frame
+    int settle;     // Frames left before the next change
+} dynres = { .scale = 1.0f, .min_scale = 1.0f, .max_scale = 1.0f };
+
 // Raylib specific
 static Texture2D screen_texture;
 static bool texture_ready = false;
 
+// Backend
+static VideoBackend backend = VIDEO_BACKEND_RAYLIB;
+static char frame_output[256] = {0}; // Null backend: file each presented frame goes to
+static int frame_number = 0;
+
 #include "../core/config.h"
 
+void Video_SetBackend(VideoBackend b) {
+    backend = b;
+}
+
+bool Video_IsHeadless(void) {
+    return backend == VIDEO_BACKEND_NULL;
+}
+
+void Video_SetFrameOutput(const char* path) {
+    if (path) {
+        strncpy(frame_output, path, sizeof(frame_output) - 1);
+    } else {
+        frame_output[0] = '\0';
+    }
+}
+
+bool Video_SaveFramebuffer(const char* path) {
+    if (!video_pixels) return false;
+    
+    // Pixels are stored as RGBA bytes, which is what Raylib's exporter expects
+    Image img = {
+        .data = video_pixels,
+        .width = VIDEO_WIDTH,
+        .height = VIDEO_HEIGHT,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+    };
+    if (!ExportImage(img, path)) {
+        printf("Video: Failed to write framebuffer to '%s'\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool Video_ShouldClose(void) {
+    if (backend == VIDEO_BACKEND_NULL) return false;
+    return WindowShouldClose();
+}
+
+// Set VIDEO_WIDTH/VIDEO_HEIGHT to a fraction of the logical resolution
+static void ApplyRenderScale(f32 scale) {
+    dynres.scale = scale;
+    VIDEO_WIDTH = (int)(display_width * scale + 0.5f);
+    VIDEO_HEIGHT = (int)(display_height * scale + 0.5f);
+    if (VIDEO_WIDTH < 1) VIDEO_WIDTH = 1;
+    if (VIDEO_HEIGHT < 1) VIDEO_HEIGHT = 1;
+}
+
+void Video_UpdateDynamicResolution(f32 frame_ms) {
+    if (!dynres.enabled) return;
+    
+    if (dynres.avg_ms <= 0) dynres.avg_ms = frame_ms;
+    else dynres.avg_ms += (frame_ms - dynres.avg_ms) * DYNRES_SMOOTHING;
+    
+    if (dynres.settle > 0) {
+        dynres.settle--;
+        return;
+    }
+    
+    // Frame cost is taken to scale with the pixel count, i.e. scale squared
+    f32 scale = dynres.scale;
+    if (dynres.avg_ms > dynres.target_ms) {
+        // Drop straight to the level predicted to fit
+        f32 fit = scale * sqrtf(dynres.target_ms / dynres.avg_ms);
+        int steps = (int)ceilf((dynres.max_scale - fit) / DYNRES_STEP - 0.001f);
+        scale = fmaxf(dynres.max_scale - steps * DYNRES_STEP, dynres.min_scale);
+        if (scale >= dynres.scale) scale = fmaxf(dynres.scale - DYNRES_STEP, dynres.min_scale);
+    } else if (scale < dynres.max_scale) {
+        // Climb one level at a time
+        f32 up = fminf(scale + DYNRES_STEP, dynres.max_scale);
+        if (dynres.avg_ms * (up * up) / (scale * scale) < dynres.target_ms * DYNRES_HEADROOM) scale = up;
+    }
+    
+    if (scale != dynres.scale) {
+        // Expected time at the new size, until its own frames come in
+        dynres.avg_ms *= (scale * scale) / (dynres.scale * dynres.scale);
+        ApplyRenderScale(scale);
+        dynres.settle = DYNRES_SETTLE_FRAMES;
+    }
+}
+
+void Video_SetDynamicResolution(bool enabled) {
+    dynres.enabled = enabled;
+    dynres.avg_ms = 0;
+    dynres.settle = 0;
+    if (!enabled) ApplyRenderScale(dynres.max_scale);
+}
+
+bool Video_IsDynamicResolution(void) {
+    return dynres.enabled;
+}
+
+f32 Video_GetRenderScale(void) {
+    return dynres.scale;
+}
+
 bool Video_Init(const char* title) {
     // Load Config
     const GameConfig* cfg = Config_Get();
-    VIDEO_WIDTH = cfg->logical_width;
-    VIDEO_HEIGHT = cfg->logical_height;
+    display_width = cfg->logical_width;
+    display_height = cfg->logical_height;
     current_scale = cfg->window_scale;
     is_fullscreen = cfg->fullscreen;
+    
+    // Render scale range; never above the logical resolution
+    dynres.max_scale = fminf(fmaxf(cfg->dynres_max_scale, 0.25f), 1.0f);
+    dynres.min_scale = fminf(fmaxf(cfg->dynres_min_scale, 0.25f), dynres.max_scale);
+    dynres.target_ms = cfg->dynres_target_ms;
+    ApplyRenderScale(dynres.max_scale);
+    Video_SetDynamicResolution(cfg->dynamic_resolution);
 
-    // Allocate framebuffer
-    frame_buffer = malloc(VIDEO_WIDTH * VIDEO_HEIGHT * sizeof(u32));
+    // Allocate framebuffer, big enough for the largest render size
+    frame_buffer = malloc(display_width * display_height * sizeof(u32));
     video_pixels = frame_buffer;
+    
+    if (!frame_buffer) {
+        printf("Video: Out of memory for %dx%d framebuffer.\n", display_width, display_height);
+        return false;
+    }
+    
+    if (dynres.enabled) {
+        printf("Video: Dynamic resolution %.0f%%-%.0f%% for %.1f ms frames\n",
+               dynres.min_scale * 100.0f, dynres.max_scale * 100.0f, dynres.target_ms);
+    }
+    
+    // Pick SIMD pixel kernels for this CPU
+    Kernels_Init();
+    
+    if (backend == VIDEO_BACKEND_NULL) {
+        printf("Video: Headless %dx%d\n", VIDEO_WIDTH, VIDEO_HEIGHT);
+        return true;
+    }
 
     // Raylib Init
     SetTraceLogLevel(LOG_WARNING); // Reduce noise
@@ -47,8 +197,8 @@ bool Video_Init(const char* title) {
         SetConfigFlags(FLAG_FULLSCREEN_MODE); // exclusive fullscreen
     }
 
-    int width = VIDEO_WIDTH * current_scale;
-    int height = VIDEO_HEIGHT * current_scale;
+    int width = display_width * current_scale;
+    int height = display_height * current_scale;
     
     InitWindow(width, height, title);
     
@@ -62,7 +212,7 @@ bool Video_Init(const char* title) {
     // We'll create a blank image first or just create texture entirely?
     // GenTexture is not exposed directly for empty.
     // We use LoadTextureFromImage with a blank image.
-    Image img = GenImageColor(VIDEO_WIDTH, VIDEO_HEIGHT, BLACK);
+    Image img = GenImageColor(display_width, display_height, BLACK);
     screen_texture = LoadTextureFromImage(img);
     UnloadImage(img);
     SetTextureFilter(screen_texture, TEXTURE_FILTER_POINT); // Pixel art style
@@ -73,20 +223,25 @@ bool Video_Init(const char* title) {
 }
 
 void Video_Shutdown(void) {
-    if (texture_ready) UnloadTexture(screen_texture);
-    CloseWindow();
+    if (backend == VIDEO_BACKEND_RAYLIB) {
+        if (texture_ready) UnloadTexture(screen_texture);
+        CloseWindow();
+    }
     if (frame_buffer) free(frame_buffer);
+    frame_buffer = NULL;
+    video_pixels = NULL;
 }
 
 void Video_ChangeScale(int delta) {
+    if (backend == VIDEO_BACKEND_NULL) return;
     if (IsWindowFullscreen()) return;
 
     current_scale += delta;
     if (current_scale < 1) current_scale = 1;
     if (current_scale > 12) current_scale = 12;
 
-    int w = VIDEO_WIDTH * current_scale;
-    int h = VIDEO_HEIGHT * current_scale;
+    int w = display_width * current_scale;
+    int h = display_height * current_scale;
     
     SetWindowSize(w, h);
     // Center window logic is a bit manual in Raylib or we assume OS handles it.
@@ -100,15 +255,14 @@ void Video_ChangeScale(int delta) {
 }
 
 void Video_ToggleFullscreen(void) {
+    if (backend == VIDEO_BACKEND_NULL) return;
     ToggleFullscreen(); // Raylib handles this
     is_fullscreen = IsWindowFullscreen();
 }
 
 void Video_Clear(Color color) {
     u32 c = (color.a << 24) | (color.b << 16) | (color.g << 8) | color.r;
-    for (int i = 0; i < VIDEO_WIDTH * VIDEO_HEIGHT; ++i) {
-        video_pixels[i] = c;
-    }
+    g_pixel_kernels->fill(video_pixels, VIDEO_WIDTH * VIDEO_HEIGHT, c);
 }
 
 void Video_PutPixel(int x, int y, Color color) {
@@ -120,28 +274,35 @@ void Video_BeginFrame(void) {
     // Prepare for drawing
     // In our case, we might update texture here?
     // Raylib's BeginDrawing() clears screen usually.
+    if (backend == VIDEO_BACKEND_NULL) return;
     BeginDrawing();
     ClearBackground(BLACK); // Clear "back" of window
 }
 
 void Video_DrawGame(void* dst_rect) {
     (void)dst_rect; // Ignored for now
+    if (backend == VIDEO_BACKEND_NULL) return;
     
     // Update GPU texture from CPU buffer
-    UpdateTexture(screen_texture, video_pixels);
+    // Only the rendered part of the texture is updated; with dynamic
+    // resolution that can be less than all of it
+    PROFILE_BEGIN("UpdateTexture");
+    UpdateTextureRec(screen_texture, (Rectangle){ 0, 0, (float)VIDEO_WIDTH, (float)VIDEO_HEIGHT }, video_pixels);
+    PROFILE_END();
     
     // Draw texture scaled to window
-    // Calculate integer scaling
+    // Calculate integer scaling of the logical resolution; the render size is
+    // stretched to fill it
     float screenW = (float)GetScreenWidth();
     float screenH = (float)GetScreenHeight();
     
-    float scale = (screenW / VIDEO_WIDTH) < (screenH / VIDEO_HEIGHT) ? (screenW / VIDEO_WIDTH) : (screenH / VIDEO_HEIGHT);
+    float scale = (screenW / display_width) < (screenH / display_height) ? (screenW / display_width) : (screenH / display_height);
     if (scale < 1.0f) scale = 1.0f;
     // Floor scale for integer scaling if desired, or keep specific aspect ratio
     scale = (float)(int)scale; // Enforce integer scaling
     
-    float viewW = VIDEO_WIDTH * scale;
-    float viewH = VIDEO_HEIGHT * scale;
+    float viewW = display_width * scale;
+    float viewH = display_height * scale;
     
     float x = (screenW - viewW) * 0.5f;
     float y = (screenH - viewH) * 0.5f;
@@ -153,6 +314,21 @@ void Video_DrawGame(void* dst_rect) {
 }
 
 void Video_EndFrame(void) {
+    if (backend == VIDEO_BACKEND_NULL) {
+        if (frame_output[0]) {
+            // The path is never used as a format, so other '%'s stay as they are
+            char path[300];
+            const char* number = strstr(frame_output, "%d");
+            if (number) {
+                snprintf(path, sizeof(path), "%.*s%d%s", (int)(number - frame_output), frame_output, frame_number, number + 2);
+            } else {
+                snprintf(path, sizeof(path), "%s", frame_output);
+            }
+            Video_SaveFramebuffer(path);
+        }
+        frame_number++;
+        return;
+    }
     EndDrawing();
 }
 
@@ -192,10 +368,25 @@ void Video_DrawVertLine(int x, int y1, int y2, Color color) {
     if (y2 >= VIDEO_HEIGHT) y2 = VIDEO_HEIGHT - 1;
     
     u32 c = (color.a << 24) | (color.b << 16) | (color.g << 8) | color.r;
+    g_pixel_kernels->fill_column(&video_pixels[y1 * VIDEO_WIDTH + x], y2 - y1 + 1, VIDEO_WIDTH, c);
+}
+
+void Video_DrawHorizLine(int y, int x1, int x2, Color color) {
+    if (y < 0 || y >= VIDEO_HEIGHT) return;
     
-    for (int y = y1; y <= y2; ++y) {
-        video_pixels[y * VIDEO_WIDTH + x] = c;
+    if (x1 > x2) {
+        int temp = x1;
+        x1 = x2;
+        x2 = temp;
     }
+    
+    if (x2 < 0 || x1 >= VIDEO_WIDTH) return;
+    
+    if (x1 < 0) x1 = 0;
+    if (x2 >= VIDEO_WIDTH) x2 = VIDEO_WIDTH - 1;
+    
+    u32 c = (color.a << 24) | (color.b << 16) | (color.g << 8) | color.r;
+    g_pixel_kernels->fill(&video_pixels[y * VIDEO_WIDTH + x1], x2 - x1 + 1, c);
 }
 
 void Video_DrawTexturedColumn(int x, int y_start, int y_end, struct GameTexture* tex, int tex_x, float v_start, float v_step) {
@@ -217,19 +408,107 @@ void Video_DrawTexturedColumn(int x, int y_start, int y_end, struct GameTexture*
     if (y2 >= VIDEO_HEIGHT) y2 = VIDEO_HEIGHT - 1;
     if (y2 < 0) return;
     
-    float v = v_start;
+    // Distant walls step over several texels per pixel; sample a smaller mip
+    u32 level;
+    tex = Texture_SelectMip(tex, fabsf(v_step), &level);
+    if (level > 0) {
+        float inv = 1.0f / (float)(1u << level);
+        tex_x >>= level;
+        v_start *= inv;
+        v_step *= inv;
+    }
+    
     u32 th = tex->height;
     u32 tw = tex->width;
-    u32* tex_pixels = tex->pixels; 
     
-    tex_x = tex_x % tw; // Wrap width
+    // Bring V into one texture period so it fits 16.16 fixed point
+    v_start = fmodf(v_start, (float)th);
+    v_step = fmodf(v_step, (float)th);
     
-    for (int y = y1; y <= y2; ++y) {
-        int tex_y = (int)v % th;
-        u32 color = tex_pixels[tex_y * tw + tex_x];
-        
-        video_pixels[y * VIDEO_WIDTH + x] = color;
+    u32* dst = &video_pixels[y1 * VIDEO_WIDTH + x];
+    int count = y2 - y1 + 1;
+    
+    if (tex->pow2) {
+        // Fast path: wrap by masking, the fixed point value may overflow freely
+        const u32* col = tex->columns + ((u32)(tex_x & (int)tex->width_mask) << tex->height_shift);
+        u32 v = (u32)(i32)(v_start * 65536.0f);
+        u32 step = (u32)(i32)(v_step * 65536.0f);
+        g_pixel_kernels->column_pow2(dst, count, VIDEO_WIDTH, col, v, step, tex->height_mask);
+        return;
+    }
+    
+    tex_x %= (int)tw; // Wrap width
+    if (tex_x < 0) tex_x += tw;
+    const u32* col = tex->columns + (u32)tex_x * th;
+    
+    i32 range = (i32)(th << 16);
+    i32 v = (i32)(v_start * 65536.0f);
+    i32 step = (i32)(v_step * 65536.0f);
+    if (v < 0) v += range;
+    if (v >= range) v -= range;
+    if (step < 0) step += range;
+    if (step >= range) step -= range;
+    
+    for (int i = 0; i < count; ++i) {
+        *dst = col[v >> 16];
+        dst += VIDEO_WIDTH;
+        v += step;
+        if (v >= range) v -= range;
+    }
+}
+
+// Wrap a 16.16 coordinate into [0, size << 16)
+static i64 WrapFixed(i64 v, u32 size) {
+    i64 range = (i64)size << 16;
+    v %= range;
+    if (v < 0) v += range;
+    return v;
+}
+
+void Video_DrawTexturedSpan(int y, int x1, int x2, struct GameTexture* tex, i64 u, i64 v, i64 du, i64 dv) {
+    if (y < 0 || y >= VIDEO_HEIGHT) return;
+    if (x1 > x2) return;
+    
+    // Clip Left
+    if (x1 < 0) {
+        u += (-x1) * du;
+        v += (-x1) * dv;
+        x1 = 0;
+    }
+    if (x1 >= VIDEO_WIDTH) return;
+    
+    // Clip Right
+    if (x2 >= VIDEO_WIDTH) x2 = VIDEO_WIDTH - 1;
+    if (x2 < 0) return;
+    
+    u32 tw = tex->width;
+    u32 th = tex->height;
+    u32* tex_pixels = tex->pixels;
+    u32* dst = &video_pixels[y * VIDEO_WIDTH];
+    
+    if (tex->pow2) {
+        // Fast path: wrap by masking. Only the low 32 bits matter since a
+        // power-of-two period divides 2^16 texels.
+        g_pixel_kernels->span_pow2(dst + x1, x2 - x1 + 1, tex_pixels, (u32)u, (u32)v, (u32)du, (u32)dv,
+                                   tex->width_mask, tex->height_mask, tex->width_shift);
+        return;
+    }
+    
+    // Keep everything inside one texture period so the loop only needs a
+    // conditional subtract to wrap
+    i32 u_range = (i32)(tw << 16);
+    i32 v_range = (i32)(th << 16);
+    i32 fu = (i32)WrapFixed(u, tw);
+    i32 fv = (i32)WrapFixed(v, th);
+    i32 fdu = (i32)WrapFixed(du, tw);
+    i32 fdv = (i32)WrapFixed(dv, th);
+    
+    for (int x = x1; x <= x2; ++x) {
+        dst[x] = tex_pixels[(fv >> 16) * tw + (fu >> 16)];
         
-        v += v_step;
+        fu += fdu;
+        if (fu >= u_range) fu -= u_range;
+        fv += fdv;
+        if (fv >= v_range) fv -= v_range;
     }
 }
@@ -17,6 +17,43 @@ extern int VIDEO_HEIGHT;
 
 extern u32* video_pixels;
 
+// Where frames go. The null backend has no window or GL context: it only
+// allocates video_pixels, and presenting is a no-op or a write to a file.
+typedef enum {
+    VIDEO_BACKEND_RAYLIB,
+    VIDEO_BACKEND_NULL
+} VideoBackend;
+
+// Select the backend. Must be called before Video_Init.
+void Video_SetBackend(VideoBackend backend);
+
+// True when running without a window (null backend)
+bool Video_IsHeadless(void);
+
+// Null backend: write every presented frame to path (PNG etc. by extension).
+// The first "%d" in path is replaced by the frame number, any other '%' is
+// kept as it is. NULL turns it off.
+void Video_SetFrameOutput(const char* path);
+
+// Write the framebuffer to an image file
+bool Video_SaveFramebuffer(const char* path);
+
+// True once the user asked to close the window (never for the null backend)
+bool Video_ShouldClose(void);
+
+// Dynamic resolution. VIDEO_WIDTH/VIDEO_HEIGHT is the size frames are
+// rendered at; Video_DrawGame scales it up to the logical resolution.
+// Feed the CPU time of each frame, without waiting for vsync. When enabled
+// (config "dynamic_resolution"), the render size steps between the configured
+// min and max scale to keep that time under the target.
+// Call between frames: the next frame renders at the new size.
+void Video_UpdateDynamicResolution(f32 frame_ms);
+void Video_SetDynamicResolution(bool enabled);
+bool Video_IsDynamicResolution(void);
+
+// Render size as a fraction of the logical resolution
+f32 Video_GetRenderScale(void);
+
 // Initialize the video system
 bool Video_Init(const char* title);
 
@@ -41,9 +78,17 @@ void Video_DrawLine(int x0, int y0, int x1, int y1, Color color);
 // Draw a vertical line
 void Video_DrawVertLine(int x, int y1, int y2, Color color);
 
+// Draw a horizontal line
+void Video_DrawHorizLine(int y, int x1, int x2, Color color);
+
 // Draw a textured column
 void Video_DrawTexturedColumn(int x, int y_start, int y_end, struct GameTexture* tex, int tex_x, float v_start, float v_step);
 
+// Draw a textured horizontal span from x1 to x2 (inclusive).
+// u/v are 16.16 fixed point texel coordinates at x1, du/dv the step per pixel.
+// Coordinates wrap, so they may be any value.
+void Video_DrawTexturedSpan(int y, int x1, int x2, struct GameTexture* tex, i64 u, i64 v, i64 du, i64 dv);
+
 // --- Advanced Rendering Pipeline (For Editor) ---
 void Video_BeginFrame(void);
 void Video_DrawGame(void* dst_rect); // If NULL, fills screen/window
@@ -0,0 +1,78 @@
+#ifndef BOOMER_BMAP_H
+#define BOOMER_BMAP_H
+
+#include "world_types.h"
+
+// Compiled binary map (.bmap), produced offline from the JSON maps.
+//
+// The file is a BMapHeader followed by plain arrays, each starting at a
+// byte offset from the start of the file aligned to BMAP_ALIGN:
+//
+//   vertex_x, vertex_y   f32[vertex_count]
+//   walls                Wall[wall_count]     (length and normal filled in)
+//   sectors              Sector[sector_count]
+//   textures             BMapTexture[texture_count]
+//   entities             BMapEntity[entity_count]
+//   pvs                  u32[pvs_stride * sector_count]   (optional)
+//   grid_cell_start      u32[grid_width * grid_height + 1] (optional)
+//   grid_cell_sectors    SectorID[grid_entries]            (optional)
+//   grid_bounds          f32[4 * sector_count]             (optional)
+//
+// Texture ids in walls and sectors index the file's texture table, -1 for
+// none. Everything is stored in the in-memory layout, so Map_Load maps the
+// file and points the map at it, copying only the walls and sectors whose
+// texture ids it rewrites. Optional sections have an offset of 0 and are
+// computed at load instead.
+//
+// Everything is little-endian. Bump BMAP_VERSION whenever this layout or
+// the Wall/Sector structs change; older files are then rejected.
+
+#define BMAP_MAGIC 0x50414D42u // "BMAP"
+#define BMAP_VERSION 2
+#define BMAP_ALIGN 8
+#define BMAP_PATH_MAX 256
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 file_size;
+
+    u32 vertex_count;
+    u32 wall_count;
+    u32 sector_count;
+    u32 texture_count;
+    u32 entity_count;
+
+    u32 pvs_stride;     // 0 if no PVS is baked
+    u32 grid_width;     // 0 if no grid is baked
+    u32 grid_height;
+    u32 grid_entries;
+    f32 grid_min_x;
+    f32 grid_min_y;
+    f32 grid_inv_cell_size;
+
+    u32 vertex_x_offset;
+    u32 vertex_y_offset;
+    u32 walls_offset;
+    u32 sectors_offset;
+    u32 textures_offset;
+    u32 entities_offset;
+    u32 pvs_offset;
+    u32 grid_cell_start_offset;
+    u32 grid_cell_sectors_offset;
+    u32 grid_bounds_offset;
+} BMapHeader;
+
+typedef struct {
+    char path[BMAP_PATH_MAX]; // Relative to textures/, NUL terminated
+} BMapTexture;
+
+typedef struct {
+    char script[BMAP_PATH_MAX]; // NUL terminated
+    Vec3 pos;
+} BMapEntity;
+
+_Static_assert(sizeof(Wall) == 36, "Wall layout changed, bump BMAP_VERSION");
+_Static_assert(sizeof(Sector) == 24, "Sector layout changed, bump BMAP_VERSION");
+
+#endif // BOOMER_BMAP_H
@@ -0,0 +1,299 @@
+#include "json_reader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JSON_MAX_DEPTH 64 // Nesting allowed in skipped values
+
+void Json_Init(JsonReader* r, const char* data, size_t size) {
+    memset(r, 0, sizeof(*r));
+    r->data = data;
+    r->size = size;
+    r->line = 1;
+}
+
+void Json_Fail(JsonReader* r, const char* message) {
+    if (r->failed) return;
+    r->failed = true;
+    snprintf(r->error, sizeof(r->error), "%d:%d: %s", r->line, (int)(r->pos - r->line_start) + 1, message);
+}
+
+static void SkipWhitespace(JsonReader* r) {
+    while (r->pos < r->size) {
+        char c = r->data[r->pos];
+        if (c == '\n') {
+            r->line++;
+            r->line_start = r->pos + 1;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            return;
+        }
+        r->pos++;
+    }
+}
+
+// Next significant character, 0 at the end of input or after an error
+static char PeekChar(JsonReader* r) {
+    if (r->failed) return 0;
+    SkipWhitespace(r);
+    return r->pos < r->size ? r->data[r->pos] : 0;
+}
+
+static bool Expect(JsonReader* r, char c, const char* message) {
+    if (PeekChar(r) != c) {
+        Json_Fail(r, message);
+        return false;
+    }
+    r->pos++;
+    return true;
+}
+
+JsonType Json_Peek(JsonReader* r) {
+    switch (PeekChar(r)) {
+    case '{': return JSON_OBJECT;
+    case '[': return JSON_ARRAY;
+    case '"': return JSON_STRING;
+    case 't': case 'f': return JSON_BOOL;
+    case 'n': return JSON_NULL;
+    case '-': case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9': return JSON_NUMBER;
+    default: return JSON_NONE;
+    }
+}
+
+bool Json_BeginObject(JsonReader* r) {
+    r->first = true;
+    return Expect(r, '{', "expected '{'");
+}
+
+bool Json_BeginArray(JsonReader* r) {
+    r->first = true;
+    return Expect(r, '[', "expected '['");
+}
+
+// Shared by objects and arrays: consume the closing character or a comma
+static bool NextItem(JsonReader* r, char close) {
+    char c = PeekChar(r);
+    if (c == close) {
+        r->pos++;
+        r->first = false;
+        return false;
+    }
+    if (!r->first) {
+        if (c != ',') {
+            Json_Fail(r, close == '}' ? "expected ',' or '}'" : "expected ',' or ']'");
+            return false;
+        }
+        r->pos++;
+    }
+    r->first = false;
+    return !r->failed;
+}
+
+bool Json_NextElement(JsonReader* r) {
+    return NextItem(r, ']');
+}
+
+bool Json_ReadNumber(JsonReader* r, f64* out) {
+    if (Json_Peek(r) != JSON_NUMBER) {
+        Json_Fail(r, "expected a number");
+        return false;
+    }
+
+    // Copy out so strtod cannot run past the end of unterminated input
+    char buf[64];
+    size_t len = 0;
+    while (r->pos + len < r->size && len < sizeof(buf) - 1) {
+        char c = r->data[r->pos + len];
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) break;
+        buf[len++] = c;
+    }
+    buf[len] = '\0';
+
+    char* end;
+    *out = strtod(buf, &end);
+    if (end == buf || (size_t)(end - buf) != len) {
+        Json_Fail(r, "malformed number");
+        return false;
+    }
+    r->pos += len;
+    return true;
+}
+
+static int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Reads a string into out, or just skips it if out is NULL. A string that
+// does not fit is cut short; *length (optional) gets its full length in
+// bytes either way.
+static bool ReadString(JsonReader* r, char* out, size_t out_size, size_t* length) {
+    if (!Expect(r, '"', "expected a string")) return false;
+
+    size_t len = 0;     // Bytes copied to out
+    size_t total = 0;   // Bytes in the whole string
+    bool fits = true;
+    while (r->pos < r->size) {
+        char c = r->data[r->pos++];
+        u32 code = (u8)c;
+        if (c == '"') {
+            if (out) out[len] = '\0';
+            if (length) *length = total;
+            return true;
+        }
+        if (code < 0x20) break; // Raw control characters, including newlines, are not allowed
+
+        if (c == '\\') {
+            if (r->pos >= r->size) break;
+            char e = r->data[r->pos++];
+            switch (e) {
+            case '"': case '\\': case '/': code = (u8)e; break;
+            case 'b': code = '\b'; break;
+            case 'f': code = '\f'; break;
+            case 'n': code = '\n'; break;
+            case 'r': code = '\r'; break;
+            case 't': code = '\t'; break;
+            case 'u': {
+                code = 0;
+                for (int i = 0; i < 4; ++i) {
+                    int d = r->pos < r->size ? HexDigit(r->data[r->pos]) : -1;
+                    if (d < 0) {
+                        Json_Fail(r, "bad \\u escape");
+                        return false;
+                    }
+                    code = code * 16 + (u32)d;
+                    r->pos++;
+                }
+                break;
+            }
+            default:
+                Json_Fail(r, "bad escape");
+                return false;
+            }
+        }
+
+        // UTF-8 encode escapes; plain bytes are copied as they are
+        char utf8[3];
+        int n = 1;
+        if (c != '\\' || code < 0x80) {
+            utf8[0] = (char)code;
+        } else if (code < 0x800) {
+            utf8[0] = (char)(0xC0 | (code >> 6));
+            utf8[1] = (char)(0x80 | (code & 0x3F));
+            n = 2;
+        } else {
+            utf8[0] = (char)(0xE0 | (code >> 12));
+            utf8[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+            utf8[2] = (char)(0x80 | (code & 0x3F));
+            n = 3;
+        }
+        total += (size_t)n;
+        if (!out || !fits) continue;
+        if (len + (size_t)n >= out_size) {
+            fits = false;
+            continue;
+        }
+        memcpy(out + len, utf8, (size_t)n);
+        len += (size_t)n;
+    }
+
+    Json_Fail(r, "unterminated string");
+    return false;
+}
+
+bool Json_ReadString(JsonReader* r, char* out, size_t out_size) {
+    size_t length;
+    if (!ReadString(r, out, out_size, &length)) return false;
+    if (length >= out_size) {
+        char message[64];
+        snprintf(message, sizeof(message), "string longer than %zu bytes", out_size - 1);
+        Json_Fail(r, message);
+        return false;
+    }
+    return true;
+}
+
+bool Json_ReadStringClipped(JsonReader* r, char* out, size_t out_size, size_t* length) {
+    return ReadString(r, out, out_size, length);
+}
+
+bool Json_NextKey(JsonReader* r, char* key, size_t key_size) {
+    if (!NextItem(r, '}')) return false;
+
+    size_t length;
+    if (!ReadString(r, key, key_size, &length)) return false;
+    if (length >= key_size) key[0] = '\0'; // Too long to be a key the caller knows
+    return Expect(r, ':', "expected ':'");
+}
+
+static bool ReadLiteral(JsonReader* r, const char* word) {
+    size_t len = strlen(word);
+    if (r->pos + len > r->size || memcmp(r->data + r->pos, word, len) != 0) {
+        Json_Fail(r, "unexpected character");
+        return false;
+    }
+    r->pos += len;
+    return true;
+}
+
+bool Json_ReadBool(JsonReader* r, bool* out) {
+    char c = PeekChar(r);
+    if (c == 't' && ReadLiteral(r, "true")) {
+        *out = true;
+        return true;
+    }
+    if (c == 'f' && ReadLiteral(r, "false")) {
+        *out = false;
+        return true;
+    }
+    Json_Fail(r, "expected true or false");
+    return false;
+}
+
+static bool SkipValue(JsonReader* r, int depth) {
+    if (depth > JSON_MAX_DEPTH) {
+        Json_Fail(r, "nested too deeply");
+        return false;
+    }
+
+    switch (Json_Peek(r)) {
+    case JSON_OBJECT:
+        if (!Json_BeginObject(r)) return false;
+        while (NextItem(r, '}')) {
+            if (!ReadString(r, NULL, 0, NULL) || !Expect(r, ':', "expected ':'")) return false;
+            if (!SkipValue(r, depth + 1)) return false;
+        }
+        return !r->failed;
+    case JSON_ARRAY:
+        if (!Json_BeginArray(r)) return false;
+        while (Json_NextElement(r)) {
+            if (!SkipValue(r, depth + 1)) return false;
+        }
+        return !r->failed;
+    case JSON_STRING:
+        return ReadString(r, NULL, 0, NULL);
+    case JSON_NUMBER: {
+        f64 ignored;
+        return Json_ReadNumber(r, &ignored);
+    }
+    case JSON_BOOL: {
+        bool ignored;
+        return Json_ReadBool(r, &ignored);
+    }
+    case JSON_NULL:
+        return ReadLiteral(r, "null");
+    default:
+        Json_Fail(r, r->pos < r->size ? "unexpected character" : "unexpected end of input");
+        return false;
+    }
+}
+
+bool Json_Skip(JsonReader* r) {
+    return SkipValue(r, 0);
+}
+
+bool Json_AtEnd(JsonReader* r) {
+    return PeekChar(r) == 0 && !r->failed && r->pos >= r->size;
+}
@@ -0,0 +1,73 @@
+#ifndef BOOMER_JSON_READER_H
+#define BOOMER_JSON_READER_H
+
+#include "../core/types.h"
+#include <stddef.h>
+
+// Pull parser for JSON text. The caller walks the document in order and
+// reads values straight into its own structures; nothing is built in
+// between. After the first error every call fails, and error holds a
+// message with the line and column where it happened.
+//
+//   Json_BeginObject(r);
+//   while (Json_NextKey(r, key, sizeof(key))) {
+//       if (strcmp(key, "x") == 0) Json_ReadNumber(r, &x);
+//       else Json_Skip(r);
+//   }
+
+typedef enum {
+    JSON_NONE,      // End of input or error
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_BOOL,
+    JSON_NULL,
+} JsonType;
+
+typedef struct {
+    const char* data;
+    size_t size;
+    size_t pos;
+    int line;               // 1-based
+    size_t line_start;      // Offset of the first character of the line
+    bool first;             // Next element/key is the first in its container
+    bool failed;
+    char error[128];
+} JsonReader;
+
+void Json_Init(JsonReader* r, const char* data, size_t size);
+
+// Type of the next value, without consuming it
+JsonType Json_Peek(JsonReader* r);
+
+// Enter an object, then call Json_NextKey until it returns false (at the
+// closing brace). Each key must be followed by reading or skipping its value.
+// A key that does not fit in key_size bytes comes back empty, so it matches
+// nothing the caller looks for.
+bool Json_BeginObject(JsonReader* r);
+bool Json_NextKey(JsonReader* r, char* key, size_t key_size);
+
+// Enter an array, then call Json_NextElement before each value until it
+// returns false (at the closing bracket)
+bool Json_BeginArray(JsonReader* r);
+bool Json_NextElement(JsonReader* r);
+
+bool Json_ReadNumber(JsonReader* r, f64* out);
+// Fails if the string does not fit in out_size bytes including the NUL
+bool Json_ReadString(JsonReader* r, char* out, size_t out_size);
+// Cuts a string that does not fit short instead. length (optional) gets its
+// full length in bytes, so the caller can report it.
+bool Json_ReadStringClipped(JsonReader* r, char* out, size_t out_size, size_t* length);
+bool Json_ReadBool(JsonReader* r, bool* out);
+
+// Skip the next value, whatever it is
+bool Json_Skip(JsonReader* r);
+
+// Record an error at the current position (the first one wins)
+void Json_Fail(JsonReader* r, const char* message);
+
+// True once the whole input has been consumed (trailing whitespace allowed)
+bool Json_AtEnd(JsonReader* r);
+
+#endif // BOOMER_JSON_READER_H
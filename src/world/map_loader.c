@@ -1,259 +1,791 @@
 #include "map_loader.h"
-#include "../core/script_sys.h" // For JS_ParseJSON
 #include "../core/fs.h"
+#include "../core/jobs.h"
+#include "../core/profiler.h"
+#include "bmap.h"
+#include "json_reader.h"
+#include "sector_grid.h"
+#include "world.h"
 #include "../video/texture.h"
 #include "../game/entity.h"
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static double GetNumber(JSContext* ctx, JSValue obj, const char* name, double def) {
-    JSValue val = JS_GetPropertyStr(ctx, obj, name);
-    double ret = def;
-    if (JS_IsNumber(val)) {
-        JS_ToFloat64(ctx, &ret, val);
-    }
-    JS_FreeValue(ctx, val);
-    return ret;
+// Hash of a point, +0.0f so -0 and 0 hash alike
+static u32 HashPoint(f32 x, f32 y) {
+    f32 fx = x + 0.0f;
+    f32 fy = y + 0.0f;
+    u32 bx, by;
+    memcpy(&bx, &fx, sizeof(bx));
+    memcpy(&by, &fy, sizeof(by));
+    u32 h = bx * 0x9E3779B1u ^ by * 0x85EBCA77u;
+    return h ^ (h >> 15);
+}
+
+// Merges wall end points with the same coordinates into one vertex.
+// Grows as points come in, since the wall count is not known up front.
+typedef struct {
+    u32* slots;     // Open addressing: vertex index + 1, 0 if empty
+    u32 mask;
+    f32* x;
+    f32* y;
+    u32 count;
+    u32 capacity;
+} VertexTable;
+
+static void VertexTable_Free(VertexTable* vt) {
+    free(vt->slots);
+    free(vt->x);
+    free(vt->y);
+    memset(vt, 0, sizeof(*vt));
 }
 
-static int GetInt(JSContext* ctx, JSValue obj, const char* name, int def) {
-    return (int)GetNumber(ctx, obj, name, (double)def);
+static void VertexTable_Insert(VertexTable* vt, u32 v) {
+    u32 i = HashPoint(vt->x[v], vt->y[v]) & vt->mask;
+    while (vt->slots[i] != 0) i = (i + 1) & vt->mask;
+    vt->slots[i] = v + 1;
 }
 
-static Vec2 GetVec2(JSContext* ctx, JSValue arr) {
-    Vec2 v = {0,0};
-    if (JS_IsArray(arr)) {
-        JSValue v0 = JS_GetPropertyUint32(ctx, arr, 0);
-        JSValue v1 = JS_GetPropertyUint32(ctx, arr, 1);
-        double d0 = 0, d1 = 0;
-        JS_ToFloat64(ctx, &d0, v0);
-        JS_ToFloat64(ctx, &d1, v1);
-        v.x = (f32)d0;
-        v.y = (f32)d1;
-        JS_FreeValue(ctx, v0);
-        JS_FreeValue(ctx, v1);
+// Make room for one more vertex, keeping the table at most half full
+static bool VertexTable_Grow(VertexTable* vt) {
+    if (vt->count < vt->capacity) return true;
+    
+    u32 capacity = vt->capacity ? vt->capacity * 2 : 64;
+    f32* x = (f32*)realloc(vt->x, sizeof(f32) * capacity);
+    if (x) vt->x = x;
+    f32* y = (f32*)realloc(vt->y, sizeof(f32) * capacity);
+    if (y) vt->y = y;
+    u32* slots = (u32*)calloc((size_t)capacity * 2, sizeof(u32));
+    if (!x || !y || !slots) {
+        free(slots);
+        return false;
     }
-    return v;
+    
+    free(vt->slots);
+    vt->slots = slots;
+    vt->mask = capacity * 2 - 1;
+    vt->capacity = capacity;
+    for (u32 v = 0; v < vt->count; ++v) VertexTable_Insert(vt, v);
+    return true;
 }
 
-static Vec3 GetVec3(JSContext* ctx, JSValue arr) {
-    Vec3 v = {0,0,0};
-    if (JS_IsArray(arr)) {
-        JSValue v0 = JS_GetPropertyUint32(ctx, arr, 0);
-        JSValue v1 = JS_GetPropertyUint32(ctx, arr, 1);
-        JSValue v2 = JS_GetPropertyUint32(ctx, arr, 2);
-        double d0=0, d1=0, d2=0;
-        JS_ToFloat64(ctx, &d0, v0);
-        JS_ToFloat64(ctx, &d1, v1);
-        JS_ToFloat64(ctx, &d2, v2);
-        v.x = (f32)d0;
-        v.y = (f32)d1;
-        v.z = (f32)d2;
-        JS_FreeValue(ctx, v0);
-        JS_FreeValue(ctx, v1);
-        JS_FreeValue(ctx, v2);
+// Index of the vertex at p, UINT32_MAX if out of memory
+static u32 VertexTable_Add(VertexTable* vt, Vec2 p) {
+    if (vt->slots) {
+        for (u32 i = HashPoint(p.x, p.y) & vt->mask;; i = (i + 1) & vt->mask) {
+            u32 slot = vt->slots[i];
+            if (slot == 0) break;
+            if (vt->x[slot - 1] == p.x && vt->y[slot - 1] == p.y) return slot - 1;
+        }
     }
+    
+    if (!VertexTable_Grow(vt)) return UINT32_MAX;
+    u32 v = vt->count++;
+    vt->x[v] = p.x;
+    vt->y[v] = p.y;
+    VertexTable_Insert(vt, v);
     return v;
 }
 
-bool Map_Load(const char* path, Map* out_map) {
-    JSContext* ctx = Script_GetContext();
-    if (!ctx) {
-        printf("Map_Load: Script system not initialized.\n");
-        return false;
+
+// --- JSON Maps ---
+
+// State while streaming through a JSON map. Sectors and walls land in
+// growable arrays as they are read, then move into the map's arena in one
+// block at the end.
+typedef struct {
+    JsonReader json;
+    MapSource* out;
+    VertexTable vertices;
+    Sector* sectors;
+    u32 sector_count;
+    u32 sector_capacity;
+    Wall* walls;
+    u32 wall_count;
+    u32 wall_capacity;
+    u32 texture_capacity;
+    u32 entity_capacity;
+} MapParser;
+
+// items with room for one more element, NULL if out of memory
+static void* Grow(MapParser* p, void* items, u32 count, u32* capacity, size_t elem_size) {
+    if (count < *capacity) return items;
+    
+    u32 new_capacity = *capacity ? *capacity * 2 : 16;
+    void* grown = realloc(items, elem_size * new_capacity);
+    if (!grown) {
+        Json_Fail(&p->json, "out of memory");
+        return NULL;
     }
+    *capacity = new_capacity;
+    return grown;
+}
 
-    char full_map_path[256];
-    snprintf(full_map_path, sizeof(full_map_path), "maps/%s", path);
+// Number value, or def if the value is of another type
+static f64 ReadNumber(MapParser* p, f64 def) {
+    f64 value = def;
+    if (Json_Peek(&p->json) == JSON_NUMBER) Json_ReadNumber(&p->json, &value);
+    else Json_Skip(&p->json);
+    return value;
+}
 
-    size_t size;
-    char* data = FS_ReadFile(full_map_path, &size);
-    if (!data) {
-        printf("Map_Load: Could not read file '%s'\n", full_map_path);
-        return false;
+// Index value (portal, texture id): an integer in [-1, INT32_MAX], def if
+// the value is of another type
+static i32 ReadIndex(MapParser* p, i32 def) {
+    if (Json_Peek(&p->json) != JSON_NUMBER) {
+        Json_Skip(&p->json);
+        return def;
+    }
+    
+    f64 value = 0.0;
+    if (!Json_ReadNumber(&p->json, &value)) return def;
+    // Range first, so the cast below is defined (NaN fails too)
+    if (!(value >= -1.0 && value <= (f64)INT32_MAX) || value != (f64)(i32)value) {
+        Json_Fail(&p->json, "expected an integer index >= -1");
+        return def;
     }
+    return (i32)value;
+}
 
-    JSValue val = JS_ParseJSON(ctx, data, size, full_map_path);
-    FS_FreeFile(data);
+// Fills out with the leading numbers of an array, anything else stays 0
+static void ReadFloats(MapParser* p, f32* out, int count) {
+    for (int i = 0; i < count; ++i) out[i] = 0.0f;
+    if (Json_Peek(&p->json) != JSON_ARRAY) {
+        Json_Skip(&p->json);
+        return;
+    }
+    
+    Json_BeginArray(&p->json);
+    for (int i = 0; Json_NextElement(&p->json); ++i) {
+        f64 value = ReadNumber(p, 0.0);
+        if (i < count) out[i] = (f32)value;
+    }
+}
 
-    if (JS_IsException(val)) {
-        printf("Map_Load: JSON Parse Error in '%s'\n", path);
-        JSValue ex = JS_GetException(ctx);
-        // Print exception details if needed
-        JS_FreeValue(ctx, ex);
-        return false;
+// String value into a fixed size path, left empty for other types
+static void ReadPath(MapParser* p, const char* what, char* out) {
+    out[0] = '\0';
+    if (Json_Peek(&p->json) != JSON_STRING) {
+        Json_Skip(&p->json);
+        return;
     }
     
-    // 1. Load Textures
-    JSValue textures = JS_GetPropertyStr(ctx, val, "textures");
-    int tex_count = 0;
-    TextureID* global_tex_ids = NULL;
+    size_t length;
+    if (Json_ReadStringClipped(&p->json, out, BMAP_PATH_MAX, &length) && length >= BMAP_PATH_MAX) {
+        char message[96];
+        snprintf(message, sizeof(message), "%s path is %zu bytes, longer than %d", what, length, BMAP_PATH_MAX - 1);
+        Json_Fail(&p->json, message);
+    }
+}
+
+// Objects where an array element should be are skipped over
+static bool BeginElement(MapParser* p) {
+    if (Json_Peek(&p->json) == JSON_OBJECT) return Json_BeginObject(&p->json);
+    Json_Skip(&p->json);
+    return false;
+}
+
+static bool BeginArray(MapParser* p) {
+    if (Json_Peek(&p->json) == JSON_ARRAY) return Json_BeginArray(&p->json);
+    Json_Skip(&p->json);
+    return false;
+}
+
+// The JSON array index is the map's local texture id:
+// "textures": [ { "id": 0, "path": ... }, { "id": 1, "path": ... } ]
+static void ParseTextures(MapParser* p) {
+    MapSource* out = p->out;
+    if (!BeginArray(p)) return;
     
-    if (JS_IsArray(textures)) {
-        JSValue len = JS_GetPropertyStr(ctx, textures, "length");
-        int length = 0;
-        JS_ToInt32(ctx, &length, len);
-        JS_FreeValue(ctx, len);
+    while (Json_NextElement(&p->json)) {
+        BMapTexture* textures = (BMapTexture*)Grow(p, out->textures, out->texture_count, &p->texture_capacity, sizeof(BMapTexture));
+        if (!textures) return;
+        out->textures = textures;
+        BMapTexture* tex = &textures[out->texture_count++];
+        tex->path[0] = '\0';
         
-        if (length > 0) {
-            global_tex_ids = (TextureID*)malloc(sizeof(TextureID) * length);
-            tex_count = length;
-            
-            // Assume we can just iterate 0..length-1
-            // But JSON IDs might be specified. The Plan said "Use the ID from JSON as the internal ID" 
-            // OR "Map it".
-            // Let's assume the JSON array index IS the local ID to simplify:
-            // "textures": [ { "id": 0 ... }, { "id": 1 ... } ]
-            // We just iterate array indices.
-            
-            for (int i = 0; i < length; ++i) {
-                JSValue item = JS_GetPropertyUint32(ctx, textures, i);
-                JSValue path_val = JS_GetPropertyStr(ctx, item, "path");
-                const char* tex_path_str = JS_ToCString(ctx, path_val);
-                
-                if (tex_path_str) {
-                    char full_tex_path[256];
-                    snprintf(full_tex_path, sizeof(full_tex_path), "textures/%s", tex_path_str);
-                    global_tex_ids[i] = Texture_Load(full_tex_path);
-                    JS_FreeCString(ctx, tex_path_str);
-                } else {
-                    global_tex_ids[i] = -1;
-                }
-                
-                JS_FreeValue(ctx, path_val);
-                JS_FreeValue(ctx, item);
-            }
+        char key[32];
+        if (!BeginElement(p)) continue;
+        while (Json_NextKey(&p->json, key, sizeof(key))) {
+            if (strcmp(key, "path") == 0) ReadPath(p, "texture", tex->path);
+            else Json_Skip(&p->json);
+        }
+    }
+}
+
+static void ParseWall(MapParser* p) {
+    Wall* walls = (Wall*)Grow(p, p->walls, p->wall_count, &p->wall_capacity, sizeof(Wall));
+    if (!walls) return;
+    p->walls = walls;
+    Wall* wall = &walls[p->wall_count++];
+    
+    Vec2 p1 = {0, 0}, p2 = {0, 0};
+    wall->next_sector = -1;
+    wall->texture_id = -1;
+    
+    char key[32];
+    if (BeginElement(p)) {
+        while (Json_NextKey(&p->json, key, sizeof(key))) {
+            if (strcmp(key, "p1") == 0) ReadFloats(p, &p1.x, 2);
+            else if (strcmp(key, "p2") == 0) ReadFloats(p, &p2.x, 2);
+            else if (strcmp(key, "portal") == 0) wall->next_sector = ReadIndex(p, -1);
+            else if (strcmp(key, "tex") == 0) wall->texture_id = ReadIndex(p, -1);
+            else Json_Skip(&p->json);
+        }
+    }
+    
+    wall->v1 = VertexTable_Add(&p->vertices, p1);
+    wall->v2 = VertexTable_Add(&p->vertices, p2);
+    if (wall->v1 == UINT32_MAX || wall->v2 == UINT32_MAX) Json_Fail(&p->json, "out of memory");
+    
+    // A single "tex" is used above and below portals too, for now
+    wall->top_texture_id = wall->texture_id;
+    wall->bottom_texture_id = wall->texture_id;
+}
+
+static void ParseWalls(MapParser* p) {
+    if (!BeginArray(p)) return;
+    while (Json_NextElement(&p->json)) ParseWall(p);
+}
+
+static void ParseSector(MapParser* p) {
+    Sector* sectors = (Sector*)Grow(p, p->sectors, p->sector_count, &p->sector_capacity, sizeof(Sector));
+    if (!sectors) return;
+    p->sectors = sectors;
+    u32 index = p->sector_count++;
+    
+    Sector sec = {
+        .floor_height = 0.0f,
+        .ceil_height = 3.0f,
+        .floor_tex_id = -1,
+        .ceil_tex_id = -1,
+        .first_wall = (i32)p->wall_count,
+    };
+    
+    // Walls go straight into the shared array, so a sector's walls are the
+    // ones read while inside it
+    char key[32];
+    if (BeginElement(p)) {
+        while (Json_NextKey(&p->json, key, sizeof(key))) {
+            if (strcmp(key, "floor_height") == 0) sec.floor_height = (f32)ReadNumber(p, 0.0);
+            else if (strcmp(key, "ceil_height") == 0) sec.ceil_height = (f32)ReadNumber(p, 3.0);
+            else if (strcmp(key, "floor_tex") == 0) sec.floor_tex_id = ReadIndex(p, -1);
+            else if (strcmp(key, "ceil_tex") == 0) sec.ceil_tex_id = ReadIndex(p, -1);
+            else if (strcmp(key, "walls") == 0) ParseWalls(p);
+            else Json_Skip(&p->json);
         }
     }
-    JS_FreeValue(ctx, textures);
+    
+    sec.num_walls = (i32)(p->wall_count - (u32)sec.first_wall);
+    p->sectors[index] = sec;
+}
+
+static void ParseSectors(MapParser* p) {
+    if (!BeginArray(p)) return;
+    while (Json_NextElement(&p->json)) ParseSector(p);
+}
 
-    // 2. Load Geometry
-    JSValue sectors = JS_GetPropertyStr(ctx, val, "sectors");
-    if (JS_IsArray(sectors)) {
-        JSValue len_val = JS_GetPropertyStr(ctx, sectors, "length");
-        int sector_count = 0;
-        JS_ToInt32(ctx, &sector_count, len_val);
-        JS_FreeValue(ctx, len_val);
+static void ParseEntities(MapParser* p) {
+    MapSource* out = p->out;
+    if (!BeginArray(p)) return;
+    
+    while (Json_NextElement(&p->json)) {
+        BMapEntity* entities = (BMapEntity*)Grow(p, out->entities, out->entity_count, &p->entity_capacity, sizeof(BMapEntity));
+        if (!entities) return;
+        out->entities = entities;
+        BMapEntity* ent = &entities[out->entity_count++];
+        memset(ent, 0, sizeof(*ent));
         
-        if (sector_count > 0) {
-            out_map->sector_count = sector_count;
-            out_map->sectors = (Sector*)malloc(sizeof(Sector) * sector_count);
-            
-            // First pass: Count walls to allocate
-            int total_walls = 0;
-            for (int i = 0; i < sector_count; ++i) {
-                JSValue idx_s = JS_GetPropertyUint32(ctx, sectors, i);
-                JSValue walls_arr = JS_GetPropertyStr(ctx, idx_s, "walls");
-                
-                if (JS_IsArray(walls_arr)) {
-                    JSValue w_len_val = JS_GetPropertyStr(ctx, walls_arr, "length");
-                    int w_len = 0;
-                    JS_ToInt32(ctx, &w_len, w_len_val);
-                    total_walls += w_len;
-                    JS_FreeValue(ctx, w_len_val);
-                }
-                
-                JS_FreeValue(ctx, walls_arr);
-                JS_FreeValue(ctx, idx_s);
-            }
-            
-            out_map->wall_count = total_walls;
-            out_map->walls = (Wall*)malloc(sizeof(Wall) * total_walls);
-            
-            // Second pass: Populate
-            int current_wall_idx = 0;
-            for (int i = 0; i < sector_count; ++i) {
-                JSValue s_obj = JS_GetPropertyUint32(ctx, sectors, i);
-                Sector* sec = &out_map->sectors[i];
-                
-                sec->floor_height = (f32)GetNumber(ctx, s_obj, "floor_height", 0.0);
-                sec->ceil_height = (f32)GetNumber(ctx, s_obj, "ceil_height", 3.0);
-                
-                int f_tid = GetInt(ctx, s_obj, "floor_tex", -1);
-                int c_tid = GetInt(ctx, s_obj, "ceil_tex", -1);
-                
-                // Map IDs
-                sec->floor_tex_id = (f_tid >= 0 && f_tid < tex_count) ? global_tex_ids[f_tid] : -1;
-                sec->ceil_tex_id = (c_tid >= 0 && c_tid < tex_count) ? global_tex_ids[c_tid] : -1;
-                
-                sec->first_wall = current_wall_idx;
-                
-                JSValue w_arr = JS_GetPropertyStr(ctx, s_obj, "walls");
-                JSValue w_len_val = JS_GetPropertyStr(ctx, w_arr, "length");
-                int w_len = 0;
-                JS_ToInt32(ctx, &w_len, w_len_val);
-                JS_FreeValue(ctx, w_len_val);
-                
-                sec->num_walls = w_len;
-                
-                for (int w = 0; w < w_len; ++w) {
-                    JSValue w_obj = JS_GetPropertyUint32(ctx, w_arr, w);
-                    Wall* wall = &out_map->walls[current_wall_idx + w];
-                    
-                    JSValue p1v = JS_GetPropertyStr(ctx, w_obj, "p1");
-                    JSValue p2v = JS_GetPropertyStr(ctx, w_obj, "p2");
-                    wall->p1 = GetVec2(ctx, p1v);
-                    wall->p2 = GetVec2(ctx, p2v);
-                    JS_FreeValue(ctx, p1v);
-                    JS_FreeValue(ctx, p2v);
-                    
-                    wall->next_sector = GetInt(ctx, w_obj, "portal", -1);
-                    
-                    // Texture mapping
-                    int tid = GetInt(ctx, w_obj, "tex", -1);
-                    wall->texture_id = (tid >= 0 && tid < tex_count) ? global_tex_ids[tid] : -1;
-                    
-                    // For now, assume single texture prop maps to Mid (Main)
-                    // If JSON had top/bottom, we'd map them too.
-                    // Let's assume if portal != -1, use same tex for top/bot by default or allow overrides?
-                    // The example JSON just has "tex". 
-                    wall->top_texture_id = wall->texture_id;
-                    wall->bottom_texture_id = wall->texture_id;
-                    
-                    JS_FreeValue(ctx, w_obj);
-                }
-                current_wall_idx += w_len;
-                
-                JS_FreeValue(ctx, w_arr);
-                JS_FreeValue(ctx, s_obj);
-            }
+        char key[32];
+        if (!BeginElement(p)) continue;
+        while (Json_NextKey(&p->json, key, sizeof(key))) {
+            if (strcmp(key, "script") == 0) ReadPath(p, "script", ent->script);
+            else if (strcmp(key, "pos") == 0) ReadFloats(p, &ent->pos.x, 3);
+            else Json_Skip(&p->json);
         }
     }
-    JS_FreeValue(ctx, sectors);
+}
+
+// Same portal check as ValidateBinary, now that the sector count is known.
+// Texture ids are range checked when they are resolved.
+static const char* ValidatePortals(const MapParser* p) {
+    for (u32 i = 0; i < p->wall_count; ++i) {
+        SectorID next = p->walls[i].next_sector;
+        if (next < -1 || next >= (i32)p->sector_count) return "portal out of range";
+    }
+    return NULL;
+}
+
+// Move the parsed geometry into one block of the map's arena
+static bool FinishGeometry(MapParser* p) {
+    Map* map = &p->out->map;
+    VertexTable* vt = &p->vertices;
+    
+    size_t sector_bytes = sizeof(Sector) * p->sector_count;
+    size_t wall_bytes = sizeof(Wall) * p->wall_count;
+    size_t vertex_bytes = sizeof(f32) * vt->count;
+    Arena_Reserve(&map->arena, sector_bytes + wall_bytes + vertex_bytes * 2 + ARENA_ALIGN * 4);
+    
+    map->sectors = (Sector*)Arena_Alloc(&map->arena, sector_bytes);
+    map->walls = (Wall*)Arena_Alloc(&map->arena, wall_bytes);
+    map->vertex_x = (f32*)Arena_Alloc(&map->arena, vertex_bytes);
+    map->vertex_y = (f32*)Arena_Alloc(&map->arena, vertex_bytes);
+    if (!map->sectors || !map->walls || !map->vertex_x || !map->vertex_y) {
+        printf("Map_ParseJSON: Out of memory for %u sectors, %u walls\n", p->sector_count, p->wall_count);
+        return false;
+    }
+    
+    if (sector_bytes) memcpy(map->sectors, p->sectors, sector_bytes);
+    if (wall_bytes) memcpy(map->walls, p->walls, wall_bytes);
+    if (vertex_bytes) {
+        memcpy(map->vertex_x, vt->x, vertex_bytes);
+        memcpy(map->vertex_y, vt->y, vertex_bytes);
+    }
+    map->sector_count = (int)p->sector_count;
+    map->wall_count = (int)p->wall_count;
+    map->vertex_count = vt->count;
+    
+    Map_UpdateWallGeometry(map);
+    return true;
+}
+
+bool Map_ParseJSON(const char* data, size_t size, const char* name, MapSource* out) {
+    memset(out, 0, sizeof(*out));
+    
+    MapParser p = { .out = out };
+    Json_Init(&p.json, data, size);
+    
+    // Single pass over the text; keys may come in any order
+    char key[32];
+    if (Json_BeginObject(&p.json)) {
+        while (Json_NextKey(&p.json, key, sizeof(key))) {
+            if (strcmp(key, "textures") == 0) ParseTextures(&p);
+            else if (strcmp(key, "sectors") == 0) ParseSectors(&p);
+            else if (strcmp(key, "entities") == 0) ParseEntities(&p);
+            else Json_Skip(&p.json);
+        }
+    }
+    if (!p.json.failed && !Json_AtEnd(&p.json)) Json_Fail(&p.json, "unexpected data after the map");
+    
+    bool ok = !p.json.failed;
+    if (!ok) printf("Map_ParseJSON: %s:%s\n", name, p.json.error);
+    
+    const char* error = ok ? ValidatePortals(&p) : NULL;
+    if (error) {
+        printf("Map_ParseJSON: %s: %s\n", name, error);
+        ok = false;
+    }
+    if (ok) ok = FinishGeometry(&p);
+    
+    free(p.sectors);
+    free(p.walls);
+    VertexTable_Free(&p.vertices);
+    
+    if (!ok) MapSource_Free(out);
+    return ok;
+}
+
+void MapSource_Free(MapSource* src) {
+    Map_Free(&src->map);
+    free(src->textures);
+    free(src->entities);
+    memset(src, 0, sizeof(*src));
+}
+
+// --- Binary Maps ---
+
+// True if count elements of elem_size at offset lie inside the file.
+// Optional sections may be absent (offset 0).
+static bool SectionFits(size_t file_size, u32 offset, u64 count, u64 elem_size, bool optional) {
+    if (offset == 0) return optional;
+    if (offset % BMAP_ALIGN != 0 || offset < sizeof(BMapHeader)) return false;
+    return (u64)offset + count * elem_size <= file_size;
+}
+
+static bool ValidTexture(i32 id, u32 texture_count) {
+    return id >= -1 && id < (i32)texture_count;
+}
+
+// Reject anything that could make the renderer index out of bounds
+static const char* ValidateBinary(const u8* data, size_t size) {
+    if (size < sizeof(BMapHeader)) return "file too small";
+    
+    const BMapHeader* h = (const BMapHeader*)data;
+    if (h->magic != BMAP_MAGIC) return "not a .bmap file";
+    if (h->version != BMAP_VERSION) return "unsupported version";
+    if (h->file_size != size) return "truncated";
+    
+    u64 cells = (u64)h->grid_width * h->grid_height;
+    if (!SectionFits(size, h->vertex_x_offset, h->vertex_count, sizeof(f32), false) ||
+        !SectionFits(size, h->vertex_y_offset, h->vertex_count, sizeof(f32), false) ||
+        !SectionFits(size, h->walls_offset, h->wall_count, sizeof(Wall), false) ||
+        !SectionFits(size, h->sectors_offset, h->sector_count, sizeof(Sector), false) ||
+        !SectionFits(size, h->textures_offset, h->texture_count, sizeof(BMapTexture), true) ||
+        !SectionFits(size, h->entities_offset, h->entity_count, sizeof(BMapEntity), true) ||
+        !SectionFits(size, h->pvs_offset, (u64)h->pvs_stride * h->sector_count, sizeof(u32), true) ||
+        !SectionFits(size, h->grid_cell_start_offset, cells + 1, sizeof(u32), true) ||
+        !SectionFits(size, h->grid_cell_sectors_offset, h->grid_entries, sizeof(SectorID), true) ||
+        !SectionFits(size, h->grid_bounds_offset, (u64)h->sector_count * 4, sizeof(f32), true)) {
+        return "section out of range";
+    }
+    if (h->texture_count && !h->textures_offset) return "missing texture table";
+    if (h->entity_count && !h->entities_offset) return "missing entity table";
+    
+    const Wall* walls = (const Wall*)(data + h->walls_offset);
+    for (u32 i = 0; i < h->wall_count; ++i) {
+        const Wall* w = &walls[i];
+        if (w->v1 >= h->vertex_count || w->v2 >= h->vertex_count) return "wall vertex out of range";
+        if (w->next_sector < -1 || w->next_sector >= (i32)h->sector_count) return "portal out of range";
+        if (!ValidTexture(w->texture_id, h->texture_count) ||
+            !ValidTexture(w->top_texture_id, h->texture_count) ||
+            !ValidTexture(w->bottom_texture_id, h->texture_count)) return "wall texture out of range";
+    }
+    
+    const Sector* sectors = (const Sector*)(data + h->sectors_offset);
+    for (u32 i = 0; i < h->sector_count; ++i) {
+        const Sector* s = &sectors[i];
+        if (s->first_wall < 0 || (u64)s->first_wall + s->num_walls > h->wall_count) return "sector walls out of range";
+        if (!ValidTexture(s->floor_tex_id, h->texture_count) ||
+            !ValidTexture(s->ceil_tex_id, h->texture_count)) return "sector texture out of range";
+    }
+    
+    const BMapTexture* textures = (const BMapTexture*)(data + h->textures_offset);
+    for (u32 i = 0; i < h->texture_count; ++i) {
+        if (!memchr(textures[i].path, 0, BMAP_PATH_MAX)) return "texture path not terminated";
+    }
+    const BMapEntity* entities = (const BMapEntity*)(data + h->entities_offset);
+    for (u32 i = 0; i < h->entity_count; ++i) {
+        if (!memchr(entities[i].script, 0, BMAP_PATH_MAX)) return "entity script not terminated";
+    }
     
-    // 3. Load Entities
-    JSValue entities = JS_GetPropertyStr(ctx, val, "entities");
-    if (JS_IsArray(entities)) {
-        JSValue len_val = JS_GetPropertyStr(ctx, entities, "length");
-        int ent_count = 0;
-        JS_ToInt32(ctx, &ent_count, len_val);
-        JS_FreeValue(ctx, len_val);
+    if (h->pvs_offset && h->pvs_stride != (h->sector_count + 31) / 32) return "bad PVS stride";
+    
+    if (h->grid_cell_start_offset) {
+        if (!cells || !(h->grid_inv_cell_size > 0) || !h->grid_cell_sectors_offset || !h->grid_bounds_offset) return "incomplete grid";
         
-        for (int i = 0; i < ent_count; ++i) {
-            JSValue e_obj = JS_GetPropertyUint32(ctx, entities, i);
-            
-            JSValue script_val = JS_GetPropertyStr(ctx, e_obj, "script");
-            const char* script = JS_ToCString(ctx, script_val);
-            
-            JSValue pos_val = JS_GetPropertyStr(ctx, e_obj, "pos");
-            Vec3 pos = GetVec3(ctx, pos_val);
-            
-            if (script) {
-                Entity_Spawn(script, pos);
-                JS_FreeCString(ctx, script);
-            }
-            
-            JS_FreeValue(ctx, pos_val);
-            JS_FreeValue(ctx, script_val);
-            JS_FreeValue(ctx, e_obj);
+        const u32* cell_start = (const u32*)(data + h->grid_cell_start_offset);
+        if (cell_start[0] != 0 || cell_start[cells] != h->grid_entries) return "bad grid";
+        for (u64 c = 0; c < cells; ++c) {
+            if (cell_start[c] > cell_start[c + 1]) return "bad grid";
+        }
+        const SectorID* cell_sectors = (const SectorID*)(data + h->grid_cell_sectors_offset);
+        for (u32 i = 0; i < h->grid_entries; ++i) {
+            if (cell_sectors[i] < 0 || cell_sectors[i] >= (i32)h->sector_count) return "grid sector out of range";
+        }
+    }
+    
+    return NULL;
+}
+
+// Copy of a section in the map's arena
+static void* CopySection(Map* map, const u8* data, u32 offset, size_t size) {
+    void* copy = Arena_Alloc(&map->arena, size);
+    if (copy) memcpy(copy, data + offset, size);
+    return copy;
+}
+
+static bool HasExtension(const char* path, const char* ext) {
+    size_t len = strlen(path);
+    size_t ext_len = strlen(ext);
+    return len >= ext_len && strcmp(path + len - ext_len, ext) == 0;
+}
+
+// --- Loading ---
+
+// A map on its way in. ReadMap and DecodeTextures only touch this, so they
+// can run on the loader thread; FinishLoad then hands the result to the
+// engine on the main thread.
+typedef struct {
+    char path[256];
+    bool binary;
+    
+    Map map;
+    MapSource source;               // JSON maps: owns the tables below
+    const BMapTexture* textures;
+    u32 texture_count;
+    const BMapEntity* entities;
+    u32 entity_count;
+    
+    TextureID* tex_ids;             // Engine id per local texture, -1 until known
+    GameTexture* decoded;           // Textures not loaded yet, pixels NULL otherwise
+    
+    atomic_uint progress;           // Per mille
+    bool ok;
+} MapLoad;
+
+static MapLoad* NewLoad(const char* path) {
+    MapLoad* ld = (MapLoad*)calloc(1, sizeof(MapLoad));
+    if (!ld) {
+        printf("Map_Load: Out of memory\n");
+        return NULL;
+    }
+    snprintf(ld->path, sizeof(ld->path), "%s", path);
+    ld->binary = HasExtension(path, ".bmap");
+    atomic_init(&ld->progress, 0);
+    return ld;
+}
+
+static void FreeLoad(MapLoad* ld) {
+    Map_Free(&ld->map); // Empty once handed over
+    MapSource_Free(&ld->source);
+    if (ld->decoded) {
+        for (u32 i = 0; i < ld->texture_count; ++i) {
+            if (ld->decoded[i].pixels) Texture_FreeDecoded(&ld->decoded[i]);
+        }
+    }
+    free(ld->decoded);
+    free(ld->tex_ids);
+    free(ld);
+}
+
+// Takes over file, whose read-only sections are used in place
+static bool ReadBinary(MapLoad* ld, FSMapping* file) {
+    Map* map = &ld->map;
+    const u8* data = (const u8*)file->data;
+    size_t size = file->size;
+    
+    // Sections are read in place, which needs the alignment they were
+    // written with. Stored zip entries can start anywhere.
+    if ((uintptr_t)data % BMAP_ALIGN != 0) {
+        u8* copy = (u8*)Arena_Alloc(&map->arena, size);
+        if (copy) memcpy(copy, data, size);
+        FS_UnmapFile(file);
+        if (!copy) {
+            printf("Map_Load: Out of memory for '%s'\n", ld->path);
+            return false;
+        }
+        data = copy;
+    } else {
+        map->file = *file;
+        memset(file, 0, sizeof(*file));
+    }
+    
+    const char* error = ValidateBinary(data, size);
+    if (error) {
+        printf("Map_Load: Invalid binary map '%s' (%s)\n", ld->path, error);
+        return false;
+    }
+    const BMapHeader* h = (const BMapHeader*)data;
+    
+    // Walls and sectors get their texture ids rewritten, so they are copied;
+    // everything else is only read and stays in the file
+    Arena_Reserve(&map->arena, sizeof(Wall) * h->wall_count + sizeof(Sector) * h->sector_count + ARENA_ALIGN * 2);
+    map->walls = (Wall*)CopySection(map, data, h->walls_offset, sizeof(Wall) * h->wall_count);
+    map->sectors = (Sector*)CopySection(map, data, h->sectors_offset, sizeof(Sector) * h->sector_count);
+    if (!map->walls || !map->sectors) {
+        printf("Map_Load: Out of memory for '%s'\n", ld->path);
+        return false;
+    }
+    map->wall_count = h->wall_count;
+    map->sector_count = h->sector_count;
+    map->vertex_x = (f32*)(data + h->vertex_x_offset);
+    map->vertex_y = (f32*)(data + h->vertex_y_offset);
+    map->vertex_count = h->vertex_count;
+    
+    ld->textures = (const BMapTexture*)(data + h->textures_offset);
+    ld->texture_count = h->texture_count;
+    ld->entities = (const BMapEntity*)(data + h->entities_offset);
+    ld->entity_count = h->entity_count;
+    
+    // Baked PVS and grid are used as they are. Without a PVS (boomer_mapc
+    // --no-pvs) everything is visible; the grid is cheap enough to build.
+    if (h->pvs_offset) {
+        map->pvs = (u32*)(data + h->pvs_offset);
+        map->pvs_stride = h->pvs_stride;
+    }
+    
+    if (h->grid_cell_start_offset) {
+        SectorGrid* g = &map->grid;
+        g->min_x = h->grid_min_x;
+        g->min_y = h->grid_min_y;
+        g->inv_cell_size = h->grid_inv_cell_size;
+        g->width = h->grid_width;
+        g->height = h->grid_height;
+        g->cell_start = (u32*)(data + h->grid_cell_start_offset);
+        g->cell_sectors = (SectorID*)(data + h->grid_cell_sectors_offset);
+        g->bounds = (f32*)(data + h->grid_bounds_offset);
+    } else {
+        SectorGrid_Build(map);
+    }
+    return true;
+}
+
+static bool ReadJSON(MapLoad* ld, FSMapping* file, const char* full_map_path) {
+    bool ok = Map_ParseJSON((const char*)file->data, file->size, full_map_path, &ld->source);
+    FS_UnmapFile(file);
+    if (!ok) return false;
+    
+    // The map moves out, the texture and entity tables stay with the source
+    ld->map = ld->source.map;
+    memset(&ld->source.map, 0, sizeof(ld->source.map));
+    ld->textures = ld->source.textures;
+    ld->texture_count = ld->source.texture_count;
+    ld->entities = ld->source.entities;
+    ld->entity_count = ld->source.entity_count;
+    
+    // Point lookup, used by the renderer and entities. The PVS is too slow to
+    // build here and is left to boomer_mapc; without one everything is visible.
+    SectorGrid_Build(&ld->map);
+    return true;
+}
+
+// 1. Read the file and build everything the map needs on its own
+static bool ReadMap(MapLoad* ld) {
+    char full_map_path[sizeof(ld->path) + 8];
+    snprintf(full_map_path, sizeof(full_map_path), "maps/%s", ld->path);
+    
+    FSMapping file;
+    if (!FS_MapFile(full_map_path, &file)) {
+        printf("Map_Load: Could not read file '%s'\n", full_map_path);
+        return false;
+    }
+    atomic_store(&ld->progress, 100);
+    
+    bool ok = ld->binary ? ReadBinary(ld, &file) : ReadJSON(ld, &file, full_map_path);
+    atomic_store(&ld->progress, 300);
+    return ok;
+}
+
+// 2. Decode the map's textures that are not loaded yet
+static bool DecodeTextures(MapLoad* ld) {
+    u32 count = ld->texture_count;
+    ld->tex_ids = (TextureID*)malloc(sizeof(TextureID) * (count ? count : 1));
+    ld->decoded = (GameTexture*)calloc(count ? count : 1, sizeof(GameTexture));
+    if (!ld->tex_ids || !ld->decoded) {
+        printf("Map_Load: Out of memory for %u textures\n", count);
+        return false;
+    }
+    
+    for (u32 i = 0; i < count; ++i) {
+        ld->tex_ids[i] = -1;
+        if (ld->textures[i].path[0] != '\0') {
+            char full_tex_path[BMAP_PATH_MAX + 16];
+            snprintf(full_tex_path, sizeof(full_tex_path), "textures/%s", ld->textures[i].path);
+            ld->tex_ids[i] = Texture_GetID(full_tex_path);
+            if (ld->tex_ids[i] == -1) Texture_Decode(full_tex_path, &ld->decoded[i]);
         }
+        atomic_store(&ld->progress, 300 + 700 * (i + 1) / count);
     }
-    JS_FreeValue(ctx, entities);
+    return true;
+}
 
-    if (global_tex_ids) free(global_tex_ids);
-    JS_FreeValue(ctx, val);
+static i32 RemapTexture(i32 id, const TextureID* tex_ids, u32 count) {
+    return (id >= 0 && id < (i32)count) ? tex_ids[id] : -1;
+}
+
+// Rewrite local texture ids in walls and sectors to engine ids
+static void ResolveTextures(Map* map, const TextureID* tex_ids, u32 count) {
+    for (u32 i = 0; i < map->wall_count; ++i) {
+        Wall* w = &map->walls[i];
+        w->texture_id = RemapTexture(w->texture_id, tex_ids, count);
+        w->top_texture_id = RemapTexture(w->top_texture_id, tex_ids, count);
+        w->bottom_texture_id = RemapTexture(w->bottom_texture_id, tex_ids, count);
+    }
+    for (u32 i = 0; i < map->sector_count; ++i) {
+        Sector* s = &map->sectors[i];
+        s->floor_tex_id = RemapTexture(s->floor_tex_id, tex_ids, count);
+        s->ceil_tex_id = RemapTexture(s->ceil_tex_id, tex_ids, count);
+    }
+}
+
+static void SpawnEntities(const BMapEntity* entities, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        if (entities[i].script[0] != '\0') Entity_Spawn(entities[i].script, entities[i].pos);
+    }
+}
+
+// 3. On the main thread: register the textures, replace the loaded map
+// with the new one and spawn its entities
+static void FinishLoad(MapLoad* ld, Map* out_map) {
+    for (u32 i = 0; i < ld->texture_count; ++i) {
+        if (!ld->decoded[i].pixels) continue;
+        char full_tex_path[BMAP_PATH_MAX + 16];
+        snprintf(full_tex_path, sizeof(full_tex_path), "textures/%s", ld->textures[i].path);
+        ld->tex_ids[i] = Texture_Add(full_tex_path, &ld->decoded[i]);
+    }
+    ResolveTextures(&ld->map, ld->tex_ids, ld->texture_count);
+    
+    Map_Free(out_map);
+    *out_map = ld->map;
+    memset(&ld->map, 0, sizeof(ld->map));
+    
+    // Binary maps keep the entity table in the file, now owned by out_map
+    SpawnEntities(ld->entities, ld->entity_count);
     
-    printf("Map_Load: Loaded '%s' (%d sectors, %d walls)\n", path, out_map->sector_count, out_map->wall_count);
+    printf("Map_Load: Loaded '%s' (%d sectors, %d walls, %d vertices, %zu KB%s)\n", ld->path, out_map->sector_count,
+           out_map->wall_count, out_map->vertex_count, out_map->arena.reserved / 1024, ld->binary ? ", binary" : "");
+}
+
+bool Map_Load(const char* path, Map* out_map) {
+    PROFILE_SCOPE("Map_Load");
+    
+    MapLoad* ld = NewLoad(path);
+    if (!ld) return false;
+    
+    bool ok = ReadMap(ld) && DecodeTextures(ld);
+    if (ok) FinishLoad(ld, out_map);
+    FreeLoad(ld);
+    return ok;
+}
+
+// --- Background Loading ---
+
+static MapLoad* g_pending = NULL;
+static JobTask* g_task = NULL;
+
+static void LoadTask(void* user) {
+    PROFILE_SCOPE("Map_Load");
+    MapLoad* ld = (MapLoad*)user;
+    ld->ok = ReadMap(ld) && DecodeTextures(ld);
+}
+
+bool Map_LoadAsync(const char* path) {
+    if (g_pending) {
+        printf("Map_LoadAsync: Still loading '%s'\n", g_pending->path);
+        return false;
+    }
+    
+    MapLoad* ld = NewLoad(path);
+    if (!ld) return false;
+    
+    g_task = Jobs_StartTask(LoadTask, ld);
+    if (!g_task) {
+        FreeLoad(ld);
+        return false;
+    }
+    g_pending = ld;
     return true;
 }
+
+MapLoadStatus Map_PollLoad(Map* out_map, f32* progress) {
+    if (!g_pending) return MAP_LOAD_IDLE;
+    
+    if (!Jobs_IsTaskDone(g_task)) {
+        if (progress) *progress = (f32)atomic_load(&g_pending->progress) / 1000.0f;
+        return MAP_LOAD_PENDING;
+    }
+    
+    MapLoad* ld = g_pending;
+    Jobs_FinishTask(g_task);
+    g_pending = NULL;
+    g_task = NULL;
+    
+    bool ok = ld->ok;
+    if (ok) FinishLoad(ld, out_map);
+    FreeLoad(ld);
+    
+    if (progress) *progress = 1.0f;
+    return ok ? MAP_LOAD_DONE : MAP_LOAD_FAILED;
+}
+
+void Map_CancelLoad(void) {
+    if (!g_pending) return;
+    
+    Jobs_FinishTask(g_task);
+    FreeLoad(g_pending);
+    g_pending = NULL;
+    g_task = NULL;
+}
@@ -2,11 +2,55 @@
 #define BOOMER_MAP_LOADER_H
 
 #include "world_types.h"
+#include "bmap.h"
 #include <stdbool.h>
+#include <stddef.h>
 
-// Load map from JSON file at path. 
+// Load map from file at path, relative to maps/.
+// Files ending in .bmap are read as compiled binary maps (see bmap.h),
+// anything else is parsed as JSON.
 // Populates the map structure. 
 // Note: This operation may reset the texture system/cache to load map-specific textures.
 bool Map_Load(const char* path, Map* out_map);
 
+// Background loading: the file is read and parsed and its textures decoded
+// on the Jobs loader thread while frames keep going. One load at a time.
+typedef enum {
+    MAP_LOAD_IDLE,      // Nothing in flight
+    MAP_LOAD_PENDING,   // Still loading, progress updated
+    MAP_LOAD_DONE,      // out_map was just replaced and its entities spawned
+    MAP_LOAD_FAILED,    // out_map is untouched
+} MapLoadStatus;
+
+// Start loading path like Map_Load. False if a load is already in flight
+// or the loader could not be started.
+bool Map_LoadAsync(const char* path);
+
+// Call once per frame on the main thread, between frames. When the load has
+// finished this swaps the new map into out_map, reporting DONE or FAILED once.
+// progress (optional) gets 0..1.
+MapLoadStatus Map_PollLoad(Map* out_map, f32* progress);
+
+// Wait for a load in flight and throw it away
+void Map_CancelLoad(void);
+
+// A map as read from its file, before any texture is loaded or entity
+// spawned. Texture ids in walls and sectors index `textures`.
+typedef struct {
+    Map map;
+    BMapTexture* textures;
+    u32 texture_count;
+    BMapEntity* entities;
+    u32 entity_count;
+} MapSource;
+
+// Parse JSON map text into out, with shared vertices merged and wall
+// lengths and normals computed. Reads the text in a single pass with
+// json_reader.h; errors are reported with name, line and column.
+// Free the result with MapSource_Free.
+bool Map_ParseJSON(const char* data, size_t size, const char* name, MapSource* out);
+
+// Free everything in src, including a PVS or grid built on src->map
+void MapSource_Free(MapSource* src);
+
 #endif // BOOMER_MAP_LOADER_H
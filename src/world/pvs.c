@@ -0,0 +1,199 @@
+#include "pvs.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PVS_MAX_DEPTH 32    // Portals in one sight line; above the renderer's MAX_RECURSION
+#define PVS_EPSILON 0.001f  // Slack when clipping, so float error only ever adds visibility
+#define PVS_MAX_FLOWS (1 << 14) // Portals flowed through per source sector before giving up on it
+
+typedef struct {
+    Vec2 a, b;
+} Segment;
+
+// State for flowing out of one source sector
+typedef struct {
+    const Map* map;
+    u32* row;       // Visibility bits of the source sector
+    u8* on_path;    // Sectors on the current portal chain
+    u32 flows;      // Portals flowed through so far, against PVS_MAX_FLOWS
+    
+    // Widest window already flowed through each wall since the chain's first
+    // portal changed, as a range along the wall from v1 (0) to v2 (1). A
+    // narrower window through the same wall can only see less, so it is
+    // skipped. This keeps open areas, where many chains lead to the same
+    // portal, from blowing up.
+    u32* window_gen;    // Matches gen if the range is from the current first portal
+    f32* window_lo;
+    f32* window_hi;
+    u32 gen;
+} FlowState;
+
+// > 0 if p is left of the line a->b, < 0 if right
+static f32 Side(Vec2 a, Vec2 b, Vec2 p) {
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+// Keep the part of seg on the `sign` side of the line a->b
+static bool ClipSegment(Segment* seg, Vec2 a, Vec2 b, f32 sign) {
+    f32 eps = PVS_EPSILON * sqrtf((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+    f32 da = Side(a, b, seg->a) * sign + eps;
+    f32 db = Side(a, b, seg->b) * sign + eps;
+
+    if (da < 0 && db < 0) return false;
+    if (da >= 0 && db >= 0) return true;
+
+    f32 t = da / (da - db);
+    Vec2 hit = { seg->a.x + (seg->b.x - seg->a.x) * t, seg->a.y + (seg->b.y - seg->a.y) * t };
+    if (da < 0) seg->a = hit;
+    else seg->b = hit;
+    return true;
+}
+
+// Clip target to the part a line through both src and pass can reach.
+// The bounds are the separating lines: through one endpoint of each portal,
+// with the rest of src on one side and the rest of pass on the other.
+static bool ClipToSeparators(const Segment* src, const Segment* pass, Segment* target) {
+    Vec2 s[2] = { src->a, src->b };
+    Vec2 p[2] = { pass->a, pass->b };
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            f32 side_src = Side(s[i], p[j], s[1 - i]);
+            f32 side_pass = Side(s[i], p[j], p[1 - j]);
+            if (side_src * side_pass >= 0) continue; // Not a separator, or degenerate
+
+            if (!ClipSegment(target, s[i], p[j], side_pass > 0 ? 1.0f : -1.0f)) return false;
+        }
+    }
+
+    // Only what lies beyond pass, away from src
+    Vec2 src_mid = { (src->a.x + src->b.x) * 0.5f, (src->a.y + src->b.y) * 0.5f };
+    f32 side = Side(pass->a, pass->b, src_mid);
+    if (side != 0 && !ClipSegment(target, pass->a, pass->b, side > 0 ? -1.0f : 1.0f)) return false;
+
+    return true;
+}
+
+// Position of p along wall a->b, 0 at a and 1 at b
+static f32 WallParam(Vec2 a, Vec2 b, Vec2 p) {
+    f32 dx = b.x - a.x;
+    f32 dy = b.y - a.y;
+    f32 len2 = dx * dx + dy * dy;
+    return len2 > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0;
+}
+
+// True if window (part of wall wid) still needs flowing through: it is not
+// inside a window already flowed through that wall from the same first portal
+static bool ClaimWindow(FlowState* st, WallID wid, const Segment* window) {
+    const Wall* wall = &st->map->walls[wid];
+    Vec2 a = Map_GetVertex(st->map, wall->v1);
+    Vec2 b = Map_GetVertex(st->map, wall->v2);
+    f32 t1 = WallParam(a, b, window->a);
+    f32 t2 = WallParam(a, b, window->b);
+    f32 lo = fminf(t1, t2);
+    f32 hi = fmaxf(t1, t2);
+    
+    if (st->window_gen[wid] == st->gen) {
+        if (lo >= st->window_lo[wid] && hi <= st->window_hi[wid]) return false;
+        if (hi - lo < st->window_hi[wid] - st->window_lo[wid]) return true; // Keep the wider one
+    }
+    st->window_gen[wid] = st->gen;
+    st->window_lo[wid] = lo;
+    st->window_hi[wid] = hi;
+    return true;
+}
+
+// Mark sector visible and continue through its portals.
+// src is the first portal of the chain and pass the (clipped) latest one;
+// both are NULL in the source sector, src is NULL one sector out.
+static void Flow(FlowState* st, SectorID sector_id, const Segment* src, const Segment* pass, int depth) {
+    st->row[(u32)sector_id >> 5] |= 1u << ((u32)sector_id & 31);
+    if (depth >= PVS_MAX_DEPTH || st->flows > PVS_MAX_FLOWS) return;
+
+    const Sector* sector = &st->map->sectors[sector_id];
+    st->on_path[sector_id] = 1;
+
+    for (u32 w = 0; w < sector->num_walls; ++w) {
+        const Wall* wall = &st->map->walls[sector->first_wall + w];
+        SectorID next = wall->next_sector;
+        if (next < 0 || (u32)next >= st->map->sector_count || st->on_path[next]) continue;
+
+        WallID wid = sector->first_wall + (WallID)w;
+        Segment target = { Map_GetVertex(st->map, wall->v1), Map_GetVertex(st->map, wall->v2) };
+        if (!pass) {
+            st->gen++; // A new first portal
+            st->flows++;
+            Flow(st, next, NULL, &target, depth + 1);
+        } else if (!src) {
+            // Any two portals can be lined up
+            if (!ClaimWindow(st, wid, &target)) continue;
+            st->flows++;
+            Flow(st, next, pass, &target, depth + 1);
+        } else if (ClipToSeparators(src, pass, &target)) {
+            if (!ClaimWindow(st, wid, &target)) continue;
+            st->flows++;
+            Flow(st, next, src, &target, depth + 1);
+        }
+    }
+
+    st->on_path[sector_id] = 0;
+}
+
+bool PVS_Build(Map* map) {
+    PVS_Free(map);
+    if (map->sector_count == 0) return true;
+
+    u32 stride = (map->sector_count + 31) / 32;
+    u32* bits = (u32*)Arena_AllocZero(&map->arena, sizeof(u32) * stride * map->sector_count);
+    u8* on_path = (u8*)calloc(map->sector_count, 1);
+    u32* window_gen = (u32*)calloc(map->wall_count, sizeof(u32));
+    f32* window_range = (f32*)malloc(sizeof(f32) * 2 * map->wall_count);
+    if (!bits || !on_path || !window_gen || !window_range) {
+        printf("PVS: Out of memory for %u sectors\n", map->sector_count);
+        free(on_path);
+        free(window_gen);
+        free(window_range);
+        return false;
+    }
+
+    FlowState st = {
+        .map = map,
+        .on_path = on_path,
+        .window_gen = window_gen,
+        .window_lo = window_range,
+        .window_hi = window_range + map->wall_count,
+    };
+    u64 total = 0;
+    u32 given_up = 0;
+    for (u32 s = 0; s < map->sector_count; ++s) {
+        st.row = bits + (size_t)s * stride;
+        st.flows = 0;
+        Flow(&st, (SectorID)s, NULL, NULL, 0);
+        
+        if (st.flows > PVS_MAX_FLOWS) {
+            // Too many sight lines to follow; everything may be visible from here
+            for (u32 t = 0; t < map->sector_count; ++t) st.row[t >> 5] |= 1u << (t & 31);
+            given_up++;
+        }
+
+        for (u32 i = 0; i < stride; ++i) {
+            total += (u32)__builtin_popcount(st.row[i]);
+        }
+    }
+    free(on_path);
+    free(window_gen);
+    free(window_range);
+
+    map->pvs = bits;
+    map->pvs_stride = stride;
+    printf("PVS: %u sectors, %.1f visible on average\n", map->sector_count, (double)total / map->sector_count);
+    if (given_up > 0) printf("PVS: %u sectors too open to flow, everything is visible from them\n", given_up);
+    return true;
+}
+
+void PVS_Free(Map* map) {
+    map->pvs = NULL;
+    map->pvs_stride = 0;
+}
@@ -0,0 +1,28 @@
+#ifndef BOOMER_PVS_H
+#define BOOMER_PVS_H
+
+#include "world_types.h"
+
+// Potentially visible set: for every sector, the set of sectors that can be
+// seen from anywhere inside it. Built by flowing sight lines through chains
+// of portals; conservative, so a sector may be listed without actually being
+// visible but never the other way round.
+
+// Compute map->pvs from the map geometry, in map->arena. Replaces any
+// existing PVS. The cost grows with how open the map is, so this runs in
+// the map compiler rather than at load; a sector with too many sight lines
+// to follow gets every sector marked visible.
+bool PVS_Build(Map* map);
+
+// Drop map->pvs. Its memory goes back with the rest of the map (Map_Free).
+void PVS_Free(Map* map);
+
+// True if sector `to` may be visible from sector `from`. Maps without a PVS
+// and invalid sectors report everything as visible.
+static inline bool PVS_IsVisible(const Map* map, SectorID from, SectorID to) {
+    if (!map->pvs || from < 0 || to < 0) return true;
+    const u32* row = map->pvs + (u32)from * map->pvs_stride;
+    return (row[(u32)to >> 5] >> ((u32)to & 31)) & 1;
+}
+
+#endif // BOOMER_PVS_H
@@ -0,0 +1,122 @@
+#include "sector_grid.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SECTOR_GRID_MAX_DIM 1024 // Cells per axis; larger maps get bigger cells
+
+// Cell range [x0, x1] x [y0, y1] covered by sector s's bounds
+static void CellRange(const SectorGrid* g, const f32* b, u32* x0, u32* y0, u32* x1, u32* y1) {
+    *x0 = (u32)((b[0] - g->min_x) * g->inv_cell_size);
+    *y0 = (u32)((b[1] - g->min_y) * g->inv_cell_size);
+    *x1 = (u32)((b[2] - g->min_x) * g->inv_cell_size);
+    *y1 = (u32)((b[3] - g->min_y) * g->inv_cell_size);
+    if (*x1 >= g->width) *x1 = g->width - 1;
+    if (*y1 >= g->height) *y1 = g->height - 1;
+}
+
+bool SectorGrid_Build(Map* map) {
+    SectorGrid_Free(map);
+    if (map->sector_count == 0 || map->vertex_count == 0) return true;
+
+    SectorGrid* g = &map->grid;
+    g->bounds = (f32*)Arena_Alloc(&map->arena, sizeof(f32) * 4 * map->sector_count);
+    if (!g->bounds) {
+        printf("SectorGrid: Out of memory for %u sectors\n", map->sector_count);
+        return false;
+    }
+
+    // Per-sector bounds, and the map bounds around them
+    f32 min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+    for (u32 s = 0; s < map->sector_count; ++s) {
+        const Sector* sec = &map->sectors[s];
+        f32* b = &g->bounds[s * 4];
+        b[0] = FLT_MAX; b[1] = FLT_MAX; b[2] = -FLT_MAX; b[3] = -FLT_MAX;
+
+        for (u32 w = 0; w < sec->num_walls; ++w) {
+            const Wall* wall = &map->walls[sec->first_wall + w];
+            Vec2 a = Map_GetVertex(map, wall->v1);
+            Vec2 c = Map_GetVertex(map, wall->v2);
+            b[0] = fminf(b[0], fminf(a.x, c.x));
+            b[1] = fminf(b[1], fminf(a.y, c.y));
+            b[2] = fmaxf(b[2], fmaxf(a.x, c.x));
+            b[3] = fmaxf(b[3], fmaxf(a.y, c.y));
+        }
+        if (sec->num_walls == 0) continue;
+
+        min_x = fminf(min_x, b[0]);
+        min_y = fminf(min_y, b[1]);
+        max_x = fmaxf(max_x, b[2]);
+        max_y = fmaxf(max_y, b[3]);
+    }
+    if (min_x > max_x) {
+        // No sector has any walls, nothing can be found
+        SectorGrid_Free(map);
+        return true;
+    }
+
+    // About one cell per sector
+    f32 extent_x = max_x - min_x;
+    f32 extent_y = max_y - min_y;
+    f32 cell_size = sqrtf(extent_x * extent_y / (f32)map->sector_count);
+    f32 min_cell_size = fmaxf(extent_x, extent_y) / (SECTOR_GRID_MAX_DIM - 1);
+    if (cell_size < min_cell_size) cell_size = min_cell_size;
+    if (cell_size <= 0) cell_size = 1.0f;
+
+    g->min_x = min_x;
+    g->min_y = min_y;
+    g->inv_cell_size = 1.0f / cell_size;
+    g->width = (u32)(extent_x * g->inv_cell_size) + 1;
+    g->height = (u32)(extent_y * g->inv_cell_size) + 1;
+
+    u32 cells = g->width * g->height;
+    g->cell_start = (u32*)Arena_AllocZero(&map->arena, sizeof(u32) * (cells + 1));
+    if (!g->cell_start) {
+        printf("SectorGrid: Out of memory for %ux%u cells\n", g->width, g->height);
+        SectorGrid_Free(map);
+        return false;
+    }
+
+    // First pass: count sectors per cell, shifted by one so the prefix sum
+    // below leaves cell_start[c] at the first slot of cell c
+    for (u32 s = 0; s < map->sector_count; ++s) {
+        if (map->sectors[s].num_walls == 0) continue;
+        u32 x0, y0, x1, y1;
+        CellRange(g, &g->bounds[s * 4], &x0, &y0, &x1, &y1);
+        for (u32 y = y0; y <= y1; ++y) {
+            for (u32 x = x0; x <= x1; ++x) g->cell_start[y * g->width + x + 1]++;
+        }
+    }
+    for (u32 c = 0; c < cells; ++c) g->cell_start[c + 1] += g->cell_start[c];
+
+    u32 total = g->cell_start[cells];
+    g->cell_sectors = (SectorID*)Arena_Alloc(&map->arena, sizeof(SectorID) * total);
+    u32* fill = (u32*)malloc(sizeof(u32) * cells);
+    if (!g->cell_sectors || !fill) {
+        printf("SectorGrid: Out of memory for %u cell entries\n", total);
+        free(fill);
+        SectorGrid_Free(map);
+        return false;
+    }
+
+    // Second pass: fill in sector order, so each cell's list stays sorted and
+    // lookups return the same sector as a linear scan would
+    for (u32 c = 0; c < cells; ++c) fill[c] = g->cell_start[c];
+    for (u32 s = 0; s < map->sector_count; ++s) {
+        if (map->sectors[s].num_walls == 0) continue;
+        u32 x0, y0, x1, y1;
+        CellRange(g, &g->bounds[s * 4], &x0, &y0, &x1, &y1);
+        for (u32 y = y0; y <= y1; ++y) {
+            for (u32 x = x0; x <= x1; ++x) g->cell_sectors[fill[y * g->width + x]++] = (SectorID)s;
+        }
+    }
+    free(fill);
+
+    printf("SectorGrid: %ux%u cells, %.1f sectors per cell\n", g->width, g->height, (f32)total / (f32)cells);
+    return true;
+}
+
+void SectorGrid_Free(Map* map) {
+    map->grid = (SectorGrid){0};
+}
@@ -0,0 +1,41 @@
+#ifndef BOOMER_SECTOR_GRID_H
+#define BOOMER_SECTOR_GRID_H
+
+#include "world_types.h"
+#include <stddef.h>
+
+// Spatial index for point to sector queries. The map bounds are split into
+// roughly one square cell per sector, and every cell lists the sectors whose
+// bounding box touches it, so GetSectorAt only runs the polygon test on a
+// handful of candidates instead of every sector in the map.
+
+// Compute map->grid from the map geometry, in map->arena. Replaces any
+// existing grid.
+bool SectorGrid_Build(Map* map);
+
+// Drop map->grid. Its memory goes back with the rest of the map (Map_Free).
+void SectorGrid_Free(Map* map);
+
+// Sectors that may contain p, in ascending order. Sets *count to 0 when p is
+// outside the map or the grid is not built.
+static inline const SectorID* SectorGrid_Candidates(const Map* map, Vec2 p, u32* count) {
+    const SectorGrid* g = &map->grid;
+    *count = 0;
+    if (!g->cell_start) return NULL;
+
+    f32 fx = (p.x - g->min_x) * g->inv_cell_size;
+    f32 fy = (p.y - g->min_y) * g->inv_cell_size;
+    if (!(fx >= 0 && fy >= 0 && fx < (f32)g->width && fy < (f32)g->height)) return NULL; // Also rejects NaN
+
+    u32 cell = (u32)fy * g->width + (u32)fx;
+    *count = g->cell_start[cell + 1] - g->cell_start[cell];
+    return &g->cell_sectors[g->cell_start[cell]];
+}
+
+// True if p is inside the bounding box of sector s
+static inline bool SectorGrid_InBounds(const Map* map, SectorID s, Vec2 p) {
+    const f32* b = &map->grid.bounds[(u32)s * 4];
+    return p.x >= b[0] && p.y >= b[1] && p.x <= b[2] && p.y <= b[3];
+}
+
+#endif // BOOMER_SECTOR_GRID_H
@@ -1,16 +1,20 @@
-#include "world_types.h"
-#include "../core/math_utils.h"
+#include "world.h"
+#include "sector_grid.h"
+#include "../core/fs.h"
+#include <math.h>
+#include <string.h>
 
 // Point in Polygon test (Ray casting algorithm)
 static bool IsPointInSector(Sector* sector, Map* map, Vec2 p) {
     bool inside = false;
     for (u32 i = 0; i < sector->num_walls; ++i) {
         Wall* w = &map->walls[sector->first_wall + i];
+        Vec2 a = Map_GetVertex(map, w->v1);
+        Vec2 b = Map_GetVertex(map, w->v2);
         
         // Check intersection with horizontal ray from p to +infinity
-        // Edge: w->p1 to w->p2
-        if (((w->p1.y > p.y) != (w->p2.y > p.y)) &&
-            (p.x < (w->p2.x - w->p1.x) * (p.y - w->p1.y) / (w->p2.y - w->p1.y) + w->p1.x)) {
+        if (((a.y > p.y) != (b.y > p.y)) &&
+            (p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x)) {
             inside = !inside;
         }
     }
@@ -18,6 +22,19 @@ static bool IsPointInSector(Sector* sector, Map* map, Vec2 p) {
 }
 
 SectorID GetSectorAt(Map* map, Vec2 pos) {
+    if (map->grid.cell_start) {
+        u32 count;
+        const SectorID* candidates = SectorGrid_Candidates(map, pos, &count);
+        for (u32 i = 0; i < count; ++i) {
+            SectorID s = candidates[i];
+            if (SectorGrid_InBounds(map, s, pos) && IsPointInSector(&map->sectors[s], map, pos)) {
+                return s;
+            }
+        }
+        return -1;
+    }
+    
+    // No grid (hand-built maps): test every sector
     for (i32 i = 0; i < (i32)map->sector_count; ++i) {
         if (IsPointInSector(&map->sectors[i], map, pos)) {
             return i;
@@ -25,3 +42,43 @@ SectorID GetSectorAt(Map* map, Vec2 pos) {
     }
     return -1;
 }
+
+void GetSectorsAt(Map* map, const Vec2* pos, SectorID* out, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        out[i] = GetSectorAt(map, pos[i]);
+    }
+}
+
+SectorID TrackSector(Map* map, SectorID last, Vec2 pos) {
+    if (last < 0 || (u32)last >= map->sector_count) return GetSectorAt(map, pos);
+    
+    Sector* sector = &map->sectors[last];
+    if (IsPointInSector(sector, map, pos)) return last;
+    
+    // Moved out, most likely through one of its portals
+    for (u32 i = 0; i < sector->num_walls; ++i) {
+        SectorID next = map->walls[sector->first_wall + i].next_sector;
+        if (next < 0 || (u32)next >= map->sector_count) continue;
+        if (IsPointInSector(&map->sectors[next], map, pos)) return next;
+    }
+    
+    // Teleported, or crossed more than one sector since the last update
+    return GetSectorAt(map, pos);
+}
+
+void Map_UpdateWallGeometry(Map* map) {
+    for (u32 i = 0; i < map->wall_count; ++i) {
+        Wall* w = &map->walls[i];
+        f32 dx = map->vertex_x[w->v2] - map->vertex_x[w->v1];
+        f32 dy = map->vertex_y[w->v2] - map->vertex_y[w->v1];
+        
+        w->length = sqrtf(dx * dx + dy * dy);
+        w->normal = (w->length > 0) ? (Vec2){ -dy / w->length, dx / w->length } : (Vec2){ 0, 0 };
+    }
+}
+
+void Map_Free(Map* map) {
+    Arena_Release(&map->arena);
+    FS_UnmapFile(&map->file);
+    memset(map, 0, sizeof(*map));
+}
@@ -4,7 +4,24 @@
 #include "world_types.h"
 #include "../core/math_utils.h"
 
-// Returns the sector ID at the given position, or -1 if none
+// Returns the sector ID at the given position, or -1 if none.
+// Uses map->grid when built (see sector_grid.h), otherwise tests every sector.
 SectorID GetSectorAt(Map* map, Vec2 pos);
 
+// GetSectorAt for count positions at once
+void GetSectorsAt(Map* map, const Vec2* pos, SectorID* out, u32 count);
+
+// Sector at pos for something last known to be in sector `last` (-1 if
+// unknown). Checks `last`, then the sectors behind its portals, before
+// falling back to GetSectorAt, so objects that move a little every frame
+// stay current for the cost of one or two point-in-sector tests.
+SectorID TrackSector(Map* map, SectorID last, Vec2 pos);
+
+// Recompute wall lengths and normals after vertices or walls change
+void Map_UpdateWallGeometry(Map* map);
+
+// Release everything the map owns (its arena and file data) and clear it.
+// Hand-built maps with static arrays are just cleared.
+void Map_Free(Map* map);
+
 #endif
@@ -2,18 +2,24 @@
 #define BOOMER_WORLD_TYPES_H
 
 #include "../core/types.h"
+#include "../core/arena.h"
+#include "../core/fs.h"
 
 // Index into array, -1 if invalid/none
 typedef i32 SectorID;
 typedef i32 WallID;
 
 typedef struct {
-    Vec2 p1, p2;
+    u32 v1, v2;           // Start and end vertex, indices into Map.vertex_x/y
     SectorID next_sector; // -1 if solid
     i32 texture_id; // Main wall texture
     i32 top_texture_id; // Wall above portal
     i32 bottom_texture_id; // Wall below portal
     
+    // Derived from the vertices by Map_UpdateWallGeometry
+    f32 length;
+    Vec2 normal;          // Unit normal into the sector (left of v1 -> v2)
+    
     // Future: Texture IDs, UV scales, etc.
 } Wall;
 
@@ -30,14 +36,51 @@ typedef struct {
     // Future: Floor/Ceiling textures, light level
 } Sector;
 
+// Uniform grid over the map bounds (see sector_grid.h). Each cell lists, in
+// ascending order, the sectors whose bounding box overlaps it.
+typedef struct {
+    f32       min_x, min_y;
+    f32       inv_cell_size;
+    u32       width, height;  // In cells
+    u32*      cell_start;     // width * height + 1 offsets into cell_sectors
+    SectorID* cell_sectors;
+    f32*      bounds;         // min_x, min_y, max_x, max_y per sector
+} SectorGrid;
+
 typedef struct Map {
+    // Wall end points, each stored once and shared by every wall that meets
+    // there (structure of arrays, so the renderer can transform them in bulk)
+    f32*    vertex_x;
+    f32*    vertex_y;
+    u32     vertex_count;
+    
     Wall*   walls;
     u32     wall_count;
     
     Sector* sectors;
     u32     sector_count;
+    
+    // Potentially visible set (see pvs.h): pvs_stride words per sector,
+    // bit t of sector s's row set if t may be seen from s. NULL if not built.
+    u32*    pvs;
+    u32     pvs_stride;
+    
+    // Point to sector lookup. cell_start is NULL if not built.
+    SectorGrid grid;
+    
+    // Every array above lives in the arena (or in file), so a map is
+    // released in one go by Map_Free
+    Arena   arena;
+    
+    // Mapped .bmap that read-only arrays such as vertex_x/y point into
+    // (see bmap.h), empty for maps built in the arena
+    FSMapping file;
 } Map;
 
+static inline Vec2 Map_GetVertex(const Map* map, u32 v) {
+    return (Vec2){ map->vertex_x[v], map->vertex_y[v] };
+}
+
 // Find which sector contains the point (x,y)
 SectorID GetSectorAt(Map* map, Vec2 pos);
 
@@ -0,0 +1,392 @@
+// Headless renderer benchmark.
+// Loads a map, moves the camera along a path and renders frames offscreen
+// with the null video backend, then reports frame time statistics as JSON.
+//
+// Usage: boomer_bench [options] game_dir map
+//   --frames N      Frames to time (default 600)
+//   --warmup N      Untimed frames rendered first (default 30)
+//   --size WxH      Resolution (default from config.json)
+//   --threads N     Render threads, 0 = one per core (default from config.json)
+//   --path FILE     Camera keyframes, one "x y z yaw" per line, # comments
+//   --orbit         Turn in place at the middle of the first sector
+//   --out FILE      Write the report to FILE instead of stdout
+// Engine log output goes to stderr, so stdout carries only the report.
+// Without --path or --orbit the camera flies through every sector reachable
+// from sector 0, crossing each portal on the way.
+// Builds with renderer counters (BOOMER_RENDER_STATS) add their per-frame
+// averages to the report.
+
+#include "core/types.h"
+#include "core/cache.h"
+#include "core/clock.h"
+#include "core/config.h"
+#include "core/fs.h"
+#include "core/jobs.h"
+#include "core/script_sys.h"
+#include "game/entity.h"
+#include "render/renderer.h"
+#include "video/kernels.h"
+#include "video/texture.h"
+#include "video/video.h"
+#include "world/map_loader.h"
+#include "world/world.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fileno _fileno
+#define fdopen _fdopen
+#else
+#include <unistd.h>
+#endif
+
+#define EYE_HEIGHT 1.5f
+
+typedef struct {
+    GameCamera* keys;
+    int count;
+    int capacity;
+} CameraPath;
+
+static void AddKey(CameraPath* path, Vec3 pos, f32 yaw) {
+    if (path->count == path->capacity) {
+        path->capacity = path->capacity ? path->capacity * 2 : 64;
+        path->keys = (GameCamera*)realloc(path->keys, sizeof(GameCamera) * path->capacity);
+    }
+    path->keys[path->count++] = (GameCamera){ pos, yaw, -1 };
+}
+
+static bool LoadPathFile(const char* filename, CameraPath* path) {
+    FILE* f = fopen(filename, "r");
+    if (!f) {
+        printf("Bench: Could not open camera path '%s'\n", filename);
+        return false;
+    }
+
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') continue;
+
+        Vec3 pos;
+        f32 yaw;
+        if (sscanf(p, "%f %f %f %f", &pos.x, &pos.y, &pos.z, &yaw) != 4) {
+            printf("Bench: %s:%d: expected \"x y z yaw\"\n", filename, line_no);
+            fclose(f);
+            return false;
+        }
+        AddKey(path, pos, yaw);
+    }
+    fclose(f);
+    return path->count > 0;
+}
+
+static Vec2 SectorCenter(const Map* map, SectorID id) {
+    const Sector* s = &map->sectors[id];
+    Vec2 c = {0, 0};
+    for (u32 w = 0; w < s->num_walls; ++w) {
+        Vec2 v = Map_GetVertex(map, map->walls[s->first_wall + w].v1);
+        c.x += v.x;
+        c.y += v.y;
+    }
+    if (s->num_walls > 0) {
+        c.x /= (f32)s->num_walls;
+        c.y /= (f32)s->num_walls;
+    }
+    return c;
+}
+
+static f32 EyeZ(const Map* map, SectorID id) {
+    const Sector* s = &map->sectors[id];
+    f32 room = s->ceil_height - s->floor_height;
+    return s->floor_height + fminf(EYE_HEIGHT, room * 0.5f);
+}
+
+// Append a key at pos facing along the direction from the previous key.
+// Yaw is unwrapped against the previous key so linear blending turns the short way.
+static void AddTravelKey(CameraPath* path, Vec3 pos) {
+    f32 yaw = 0.0f;
+    if (path->count > 0) {
+        GameCamera* prev = &path->keys[path->count - 1];
+        f32 dx = pos.x - prev->pos.x;
+        f32 dy = pos.y - prev->pos.y;
+        yaw = (dx == 0 && dy == 0) ? prev->yaw : atan2f(dy, dx);
+        while (yaw - prev->yaw > PI) yaw -= 2.0f * PI;
+        while (yaw - prev->yaw < -PI) yaw += 2.0f * PI;
+        if (path->count == 1) prev->yaw = yaw; // Start facing the first leg
+    }
+    AddKey(path, pos, yaw);
+}
+
+// Depth-first tour over portals: into each unvisited neighbour through the
+// middle of the shared portal, and back out the same way
+static void TourSector(const Map* map, SectorID id, u8* visited, CameraPath* path) {
+    visited[id] = 1;
+    Vec2 c = SectorCenter(map, id);
+    Vec3 center = { c.x, c.y, EyeZ(map, id) };
+    AddTravelKey(path, center);
+
+    const Sector* s = &map->sectors[id];
+    for (u32 w = 0; w < s->num_walls; ++w) {
+        const Wall* wall = &map->walls[s->first_wall + w];
+        SectorID next = wall->next_sector;
+        if (next < 0 || (u32)next >= map->sector_count || visited[next]) continue;
+
+        Vec2 a = Map_GetVertex(map, wall->v1);
+        Vec2 b = Map_GetVertex(map, wall->v2);
+        Vec3 door = { (a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, EyeZ(map, id) };
+        AddTravelKey(path, door);
+        TourSector(map, next, visited, path);
+        AddTravelKey(path, door);
+        AddTravelKey(path, center);
+    }
+}
+
+static void BuildFlyThrough(const Map* map, CameraPath* path) {
+    u8* visited = (u8*)calloc(map->sector_count, 1);
+    TourSector(map, 0, visited, path);
+    free(visited);
+}
+
+static void BuildOrbit(const Map* map, CameraPath* path) {
+    Vec2 c = SectorCenter(map, 0);
+    Vec3 pos = { c.x, c.y, EyeZ(map, 0) };
+    for (int i = 0; i <= 4; ++i) {
+        AddKey(path, pos, (f32)i * 0.5f * PI);
+    }
+}
+
+// Camera at t in [0, 1] along the path
+static GameCamera SamplePath(const CameraPath* path, f32 t) {
+    if (path->count == 1) return path->keys[0];
+
+    f32 f = t * (f32)(path->count - 1);
+    int i = (int)f;
+    if (i >= path->count - 1) return path->keys[path->count - 1];
+    f -= (f32)i;
+
+    const GameCamera* a = &path->keys[i];
+    const GameCamera* b = &path->keys[i + 1];
+    return (GameCamera){
+        .pos = {
+            a->pos.x + (b->pos.x - a->pos.x) * f,
+            a->pos.y + (b->pos.y - a->pos.y) * f,
+            a->pos.z + (b->pos.z - a->pos.z) * f
+        },
+        .yaw = a->yaw + (b->yaw - a->yaw) * f,
+        .sector = -1
+    };
+}
+
+static int CompareF64(const void* a, const void* b) {
+    f64 x = *(const f64*)a;
+    f64 y = *(const f64*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted values
+static f64 Percentile(const f64* sorted, int count, f64 p) {
+    int rank = (int)ceil(p / 100.0 * count);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+// s as a quoted JSON string
+static void WriteJsonString(FILE* out, const char* s) {
+    fputc('"', out);
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c < 0x20) fprintf(out, "\\u%04x", c);
+        else fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+// Point stdout at stderr so the engine's printf logging stays out of the
+// report. Returns a stream on the original stdout, NULL on failure.
+static FILE* DivertLogs(void) {
+    fflush(stdout);
+    int report_fd = dup(fileno(stdout));
+    if (report_fd < 0) return NULL;
+    if (dup2(fileno(stderr), fileno(stdout)) < 0) return NULL;
+    return fdopen(report_fd, "w");
+}
+
+static void Usage(void) {
+    printf("Usage: boomer_bench [--frames N] [--warmup N] [--size WxH] [--threads N]\n"
+           "                    [--path FILE | --orbit] [--out FILE] game_dir map\n");
+}
+
+int main(int argc, char** argv) {
+    int frames = 600;
+    int warmup = 30;
+    int width = 0, height = 0;
+    int threads = -1;
+    bool orbit = false;
+    const char* path_file = NULL;
+    const char* out_file = NULL;
+    const char* game_dir = NULL;
+    const char* map_name = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(a, "--frames") == 0 && has_value) frames = atoi(argv[++i]);
+        else if (strcmp(a, "--warmup") == 0 && has_value) warmup = atoi(argv[++i]);
+        else if (strcmp(a, "--size") == 0 && has_value) sscanf(argv[++i], "%dx%d", &width, &height);
+        else if (strcmp(a, "--threads") == 0 && has_value) threads = atoi(argv[++i]);
+        else if (strcmp(a, "--path") == 0 && has_value) path_file = argv[++i];
+        else if (strcmp(a, "--orbit") == 0) orbit = true;
+        else if (strcmp(a, "--out") == 0 && has_value) out_file = argv[++i];
+        else if (a[0] == '-') { Usage(); return 1; }
+        else if (!game_dir) game_dir = a;
+        else if (!map_name) map_name = a;
+        else { Usage(); return 1; }
+    }
+    if (!game_dir || !map_name || frames < 1) {
+        Usage();
+        return 1;
+    }
+
+    FILE* report = DivertLogs();
+    if (!report) {
+        fprintf(stderr, "Bench: Could not redirect log output\n");
+        return 1;
+    }
+
+    // Engine setup, as in main.c but without a window
+    if (!FS_Init(game_dir)) return 1;
+    Config_Load();
+
+    GameConfig* cfg = Config_Edit();
+    if (width > 0 && height > 0) {
+        cfg->logical_width = (width < MAX_VIDEO_WIDTH) ? width : MAX_VIDEO_WIDTH;
+        cfg->logical_height = (height < MAX_VIDEO_HEIGHT) ? height : MAX_VIDEO_HEIGHT;
+    }
+    if (threads >= 0) cfg->render_threads = threads;
+    Cache_SetBudget((size_t)cfg->resource_cache_mb * 1024 * 1024);
+
+    Jobs_Init(cfg->render_threads);
+    if (!Script_Init()) return 1;
+    Entity_Init();
+
+    Video_SetBackend(VIDEO_BACKEND_NULL);
+    if (!Video_Init("boomer_bench")) return 1;
+    Renderer_Init();
+    Texture_Init();
+
+    Map map = {0};
+    if (!Map_Load(map_name, &map) || map.sector_count == 0) {
+        printf("Bench: Failed to load map '%s'\n", map_name);
+        return 1;
+    }
+
+    CameraPath path = {0};
+    if (path_file) {
+        if (!LoadPathFile(path_file, &path)) return 1;
+    } else if (orbit) {
+        BuildOrbit(&map, &path);
+    } else {
+        BuildFlyThrough(&map, &path);
+    }
+
+    // Carry the camera's sector along the path, as the game does
+    SectorID sector = -1;
+    for (int i = 0; i < warmup; ++i) {
+        GameCamera cam = SamplePath(&path, (f32)i / (f32)(warmup > 1 ? warmup - 1 : 1));
+        cam.sector = sector = TrackSector(&map, sector, (Vec2){cam.pos.x, cam.pos.y});
+        Render_Frame(cam, &map);
+    }
+
+    f64* times = (f64*)malloc(sizeof(f64) * frames);
+    f64 total = 0;
+    f64 stat_sum[8] = {0};
+    for (int i = 0; i < frames; ++i) {
+        GameCamera cam = SamplePath(&path, (f32)i / (f32)(frames > 1 ? frames - 1 : 1));
+        cam.sector = sector = TrackSector(&map, sector, (Vec2){cam.pos.x, cam.pos.y});
+        f64 start = Clock_Now();
+        Render_Frame(cam, &map);
+        times[i] = Clock_Now() - start;
+        total += times[i];
+        
+        const RenderStats* rs = Render_GetStats();
+        stat_sum[0] += rs->sectors_visited;
+        stat_sum[1] += rs->walls_transformed;
+        stat_sum[2] += rs->walls_culled;
+        stat_sum[3] += rs->portals_recursed;
+        stat_sum[4] += rs->columns_drawn;
+        stat_sum[5] += rs->wall_pixels;
+        stat_sum[6] += rs->flat_pixels;
+        stat_sum[7] += rs->overdraw;
+    }
+
+    qsort(times, frames, sizeof(f64), CompareF64);
+    f64 avg = total / frames;
+    f64 pixels = (f64)VIDEO_WIDTH * VIDEO_HEIGHT * frames;
+
+    FILE* out = report;
+    if (out_file) {
+        out = fopen(out_file, "w");
+        if (!out) {
+            printf("Bench: Could not write '%s'\n", out_file);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"map\": ");
+    WriteJsonString(out, map_name);
+    fprintf(out, ",\n");
+    fprintf(out, "  \"width\": %d,\n", VIDEO_WIDTH);
+    fprintf(out, "  \"height\": %d,\n", VIDEO_HEIGHT);
+    fprintf(out, "  \"threads\": %d,\n", Jobs_GetThreadCount());
+    fprintf(out, "  \"kernels\": \"%s\",\n", g_pixel_kernels->name);
+    fprintf(out, "  \"camera_path\": \"%s\",\n", path_file ? "file" : (orbit ? "orbit" : "fly-through"));
+    fprintf(out, "  \"frames\": %d,\n", frames);
+    fprintf(out, "  \"frame_ms\": {\n");
+    fprintf(out, "    \"min\": %.4f,\n", times[0] * 1000.0);
+    fprintf(out, "    \"avg\": %.4f,\n", avg * 1000.0);
+    fprintf(out, "    \"p50\": %.4f,\n", Percentile(times, frames, 50) * 1000.0);
+    fprintf(out, "    \"p95\": %.4f,\n", Percentile(times, frames, 95) * 1000.0);
+    fprintf(out, "    \"p99\": %.4f,\n", Percentile(times, frames, 99) * 1000.0);
+    fprintf(out, "    \"max\": %.4f\n", times[frames - 1] * 1000.0);
+    fprintf(out, "  },\n");
+    fprintf(out, "  \"fps_avg\": %.2f,\n", 1.0 / avg);
+#if BOOMER_RENDER_STATS
+    static const char* stat_names[8] = {
+        "sectors_visited", "walls_transformed", "walls_culled", "portals_recursed",
+        "columns_drawn", "wall_pixels", "flat_pixels", "overdraw"
+    };
+    fprintf(out, "  \"render_stats_avg\": {\n");
+    for (int i = 0; i < 8; ++i) {
+        fprintf(out, "    \"%s\": %.2f%s\n", stat_names[i], stat_sum[i] / frames, i < 7 ? "," : "");
+    }
+    fprintf(out, "  },\n");
+#endif
+    fprintf(out, "  \"pixels_per_sec\": %.0f\n", pixels / total);
+    fprintf(out, "}\n");
+    if (out != report) fclose(out);
+    fclose(report);
+
+    free(times);
+    free(path.keys);
+    Map_Free(&map);
+
+    Video_Shutdown();
+    Texture_Shutdown();
+    Entity_Shutdown();
+    Script_Shutdown();
+    Cache_Shutdown();
+    Jobs_Shutdown();
+    FS_Shutdown();
+    return 0;
+}
@@ -0,0 +1,378 @@
+// Offline map compiler.
+// Turns JSON maps into compiled binary maps (.bmap, see world/bmap.h) that
+// Map_Load reads without any parsing or preprocessing.
+//
+// Usage: boomer_mapc [options] map.json...
+//   -o FILE         Output file (one input only; default: input with .bmap)
+//   --no-pvs        Leave out the potentially visible set (all visible)
+//   --no-reorder    Keep sectors and walls in source order
+// For every map it checks that portals are two-sided, merges shared
+// vertices, precomputes wall lengths, normals, sector bounds, the sector
+// grid and the PVS, and renumbers sectors breadth-first through the portals so that
+// neighbours sit next to each other in memory. Exits non-zero if any map
+// has errors.
+
+#include "core/types.h"
+#include "world/bmap.h"
+#include "world/map_loader.h"
+#include "world/pvs.h"
+#include "world/sector_grid.h"
+#include "world/world.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    bool bake_pvs;
+    bool reorder;
+} CompileOptions;
+
+static char* ReadHostFile(const char* filename, size_t* out_size) {
+    FILE* f = fopen(filename, "rb");
+    if (!f) return NULL;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char* data = size >= 0 ? (char*)malloc((size_t)size + 1) : NULL;
+    if (data && fread(data, 1, (size_t)size, f) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+
+    if (data) {
+        data[size] = '\0';
+        *out_size = (size_t)size;
+    }
+    return data;
+}
+
+// --- Validation ---
+
+static bool HasReturnPortal(const Map* map, SectorID from, const Wall* wall) {
+    const Sector* next = &map->sectors[wall->next_sector];
+    for (u32 i = 0; i < next->num_walls; ++i) {
+        const Wall* back = &map->walls[next->first_wall + i];
+        if (back->next_sector == from && back->v1 == wall->v2 && back->v2 == wall->v1) return true;
+    }
+    return false;
+}
+
+static i32 CheckTexture(i32 id, u32 texture_count, const char* filename, u32 sector, const char* what, int* warnings) {
+    if (id >= -1 && id < (i32)texture_count) return id;
+    printf("%s: warning: sector %u %s texture %d does not exist\n", filename, sector, what, id);
+    (*warnings)++;
+    return -1;
+}
+
+static i32 CheckWallTexture(i32 id, u32 texture_count, const char* filename, u32 sector, u32 wall, const char* what, int* warnings) {
+    char label[48];
+    snprintf(label, sizeof(label), "wall %u %s", wall, what);
+    return CheckTexture(id, texture_count, filename, sector, label, warnings);
+}
+
+// Report problems; fixes what can be fixed (missing textures), returns the
+// number of errors
+static int Validate(MapSource* src, const char* filename) {
+    Map* map = &src->map;
+    int errors = 0;
+    int warnings = 0;
+
+    for (u32 s = 0; s < map->sector_count; ++s) {
+        Sector* sec = &map->sectors[s];
+        if (sec->num_walls < 3) {
+            printf("%s: warning: sector %u has %u walls\n", filename, s, sec->num_walls);
+            warnings++;
+        }
+        if (sec->ceil_height < sec->floor_height) {
+            printf("%s: warning: sector %u ceiling is below its floor\n", filename, s);
+            warnings++;
+        }
+        sec->floor_tex_id = CheckTexture(sec->floor_tex_id, src->texture_count, filename, s, "floor", &warnings);
+        sec->ceil_tex_id = CheckTexture(sec->ceil_tex_id, src->texture_count, filename, s, "ceiling", &warnings);
+
+        for (u32 w = 0; w < sec->num_walls; ++w) {
+            Wall* wall = &map->walls[sec->first_wall + w];
+            wall->texture_id = CheckWallTexture(wall->texture_id, src->texture_count, filename, s, w, "wall", &warnings);
+            wall->top_texture_id = CheckWallTexture(wall->top_texture_id, src->texture_count, filename, s, w, "upper", &warnings);
+            wall->bottom_texture_id = CheckWallTexture(wall->bottom_texture_id, src->texture_count, filename, s, w, "lower", &warnings);
+
+            if (wall->length <= 0) {
+                printf("%s: warning: sector %u wall %u has zero length\n", filename, s, w);
+                warnings++;
+            }
+
+            SectorID next = wall->next_sector;
+            if (next < 0) continue;
+            if (next >= (SectorID)map->sector_count || next == (SectorID)s) {
+                printf("%s: error: sector %u wall %u is a portal to sector %d\n", filename, s, w, next);
+                errors++;
+            } else if (!HasReturnPortal(map, (SectorID)s, wall)) {
+                printf("%s: error: sector %u wall %u is a portal to sector %d, which has no matching portal back\n",
+                       filename, s, w, next);
+                errors++;
+            }
+        }
+    }
+
+    if (errors || warnings) printf("%s: %d error(s), %d warning(s)\n", filename, errors, warnings);
+    return errors;
+}
+
+// --- Reordering ---
+
+// Renumber sectors in breadth-first order through the portals, starting
+// from sector 0 (where the game looks first), and lay out walls and
+// vertices in the order those sectors use them. The reordered arrays are
+// new allocations in the map's arena.
+static bool Reorder(Map* map) {
+    u32 n = map->sector_count;
+    SectorID* order = (SectorID*)malloc(sizeof(SectorID) * (n ? n : 1));
+    SectorID* new_index = (SectorID*)malloc(sizeof(SectorID) * (n ? n : 1));
+    u32* new_vertex = (u32*)malloc(sizeof(u32) * (map->vertex_count ? map->vertex_count : 1));
+    Sector* sectors = (Sector*)Arena_Alloc(&map->arena, sizeof(Sector) * n);
+    Wall* walls = (Wall*)Arena_Alloc(&map->arena, sizeof(Wall) * map->wall_count);
+    f32* vertex_x = (f32*)Arena_Alloc(&map->arena, sizeof(f32) * map->vertex_count);
+    f32* vertex_y = (f32*)Arena_Alloc(&map->arena, sizeof(f32) * map->vertex_count);
+    if (!order || !new_index || !new_vertex || !sectors || !walls || !vertex_x || !vertex_y) {
+        free(order);
+        free(new_index);
+        free(new_vertex);
+        return false;
+    }
+
+    // Unreachable sectors start a new search, in source order
+    for (u32 s = 0; s < n; ++s) new_index[s] = -1;
+    u32 count = 0;
+    for (u32 root = 0; root < n; ++root) {
+        if (new_index[root] >= 0) continue;
+        new_index[root] = (SectorID)count;
+        order[count++] = (SectorID)root;
+
+        for (u32 head = count - 1; head < count; ++head) {
+            const Sector* sec = &map->sectors[order[head]];
+            for (u32 w = 0; w < sec->num_walls; ++w) {
+                SectorID next = map->walls[sec->first_wall + w].next_sector;
+                if (next < 0 || new_index[next] >= 0) continue;
+                new_index[next] = (SectorID)count;
+                order[count++] = next;
+            }
+        }
+    }
+
+    for (u32 v = 0; v < map->vertex_count; ++v) new_vertex[v] = UINT32_MAX;
+    u32 wall_count = 0;
+    u32 vertex_count = 0;
+    for (u32 i = 0; i < n; ++i) {
+        const Sector* old = &map->sectors[order[i]];
+        sectors[i] = *old;
+        sectors[i].first_wall = (WallID)wall_count;
+
+        for (u32 w = 0; w < old->num_walls; ++w) {
+            Wall wall = map->walls[old->first_wall + w];
+            if (wall.next_sector >= 0) wall.next_sector = new_index[wall.next_sector];
+
+            u32* ends[2] = { &wall.v1, &wall.v2 };
+            for (int e = 0; e < 2; ++e) {
+                u32 v = *ends[e];
+                if (new_vertex[v] == UINT32_MAX) {
+                    new_vertex[v] = vertex_count;
+                    vertex_x[vertex_count] = map->vertex_x[v];
+                    vertex_y[vertex_count] = map->vertex_y[v];
+                    vertex_count++;
+                }
+                *ends[e] = new_vertex[v];
+            }
+            walls[wall_count++] = wall;
+        }
+    }
+
+    map->sectors = sectors;
+    map->walls = walls;
+    map->wall_count = wall_count; // Walls outside every sector are dropped
+    map->vertex_x = vertex_x;
+    map->vertex_y = vertex_y;
+    map->vertex_count = vertex_count;
+
+    free(order);
+    free(new_index);
+    free(new_vertex);
+    return true;
+}
+
+// --- Output ---
+
+typedef struct {
+    u8* data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+} OutBuffer;
+
+// Append size bytes at the next BMAP_ALIGN boundary, returns their offset
+static u32 Put(OutBuffer* buf, const void* data, size_t size) {
+    size_t offset = (buf->size + BMAP_ALIGN - 1) & ~(size_t)(BMAP_ALIGN - 1);
+    if (buf->failed || offset + size > UINT32_MAX) {
+        buf->failed = true;
+        return 0;
+    }
+
+    if (offset + size > buf->capacity) {
+        size_t capacity = buf->capacity * 2 + size + BMAP_ALIGN;
+        u8* grown = (u8*)realloc(buf->data, capacity);
+        if (!grown) {
+            buf->failed = true;
+            return 0;
+        }
+        buf->data = grown;
+        buf->capacity = capacity;
+    }
+
+    memset(buf->data + buf->size, 0, offset - buf->size);
+    if (size) memcpy(buf->data + offset, data, size);
+    buf->size = offset + size;
+    return (u32)offset;
+}
+
+static bool WriteBinary(const MapSource* src, const char* filename) {
+    const Map* map = &src->map;
+    const SectorGrid* g = &map->grid;
+    BMapHeader h = {
+        .magic = BMAP_MAGIC,
+        .version = BMAP_VERSION,
+        .vertex_count = map->vertex_count,
+        .wall_count = map->wall_count,
+        .sector_count = map->sector_count,
+        .texture_count = src->texture_count,
+        .entity_count = src->entity_count,
+    };
+
+    OutBuffer buf = {0};
+    Put(&buf, &h, sizeof(h)); // Filled in at the end
+
+    h.vertex_x_offset = Put(&buf, map->vertex_x, sizeof(f32) * map->vertex_count);
+    h.vertex_y_offset = Put(&buf, map->vertex_y, sizeof(f32) * map->vertex_count);
+    h.walls_offset = Put(&buf, map->walls, sizeof(Wall) * map->wall_count);
+    h.sectors_offset = Put(&buf, map->sectors, sizeof(Sector) * map->sector_count);
+    if (src->texture_count) h.textures_offset = Put(&buf, src->textures, sizeof(BMapTexture) * src->texture_count);
+    if (src->entity_count) h.entities_offset = Put(&buf, src->entities, sizeof(BMapEntity) * src->entity_count);
+
+    if (map->pvs) {
+        h.pvs_stride = map->pvs_stride;
+        h.pvs_offset = Put(&buf, map->pvs, sizeof(u32) * map->pvs_stride * map->sector_count);
+    }
+
+    if (g->cell_start) {
+        u32 cells = g->width * g->height;
+        h.grid_width = g->width;
+        h.grid_height = g->height;
+        h.grid_entries = g->cell_start[cells];
+        h.grid_min_x = g->min_x;
+        h.grid_min_y = g->min_y;
+        h.grid_inv_cell_size = g->inv_cell_size;
+        h.grid_cell_start_offset = Put(&buf, g->cell_start, sizeof(u32) * (cells + 1));
+        h.grid_cell_sectors_offset = Put(&buf, g->cell_sectors, sizeof(SectorID) * h.grid_entries);
+        h.grid_bounds_offset = Put(&buf, g->bounds, sizeof(f32) * 4 * map->sector_count);
+    }
+
+    if (buf.failed) {
+        printf("%s: error: out of memory\n", filename);
+        free(buf.data);
+        return false;
+    }
+    h.file_size = (u32)buf.size;
+    memcpy(buf.data, &h, sizeof(h));
+
+    FILE* f = fopen(filename, "wb");
+    bool ok = f && fwrite(buf.data, 1, buf.size, f) == buf.size;
+    if (f && fclose(f) != 0) ok = false;
+    if (!ok) printf("%s: error: could not write file\n", filename);
+    else printf("%s: %u sectors, %u walls, %u vertices, %zu bytes\n", filename, map->sector_count, map->wall_count, map->vertex_count, buf.size);
+
+    free(buf.data);
+    return ok;
+}
+
+static bool Compile(const char* in_file, const char* out_file, const CompileOptions* opts) {
+    size_t size;
+    char* data = ReadHostFile(in_file, &size);
+    if (!data) {
+        printf("%s: error: could not read file\n", in_file);
+        return false;
+    }
+
+    MapSource src;
+    bool ok = Map_ParseJSON(data, size, in_file, &src);
+    free(data);
+    if (!ok) return false;
+
+    ok = Validate(&src, in_file) == 0;
+    if (ok && opts->reorder && !Reorder(&src.map)) {
+        printf("%s: error: out of memory\n", in_file);
+        ok = false;
+    }
+    if (ok) ok = SectorGrid_Build(&src.map);
+    if (ok && opts->bake_pvs) ok = PVS_Build(&src.map);
+    if (ok) ok = WriteBinary(&src, out_file);
+
+    MapSource_Free(&src);
+    return ok;
+}
+
+static void PrintUsage(void) {
+    printf("Usage: boomer_mapc [-o FILE] [--no-pvs] [--no-reorder] map.json...\n");
+}
+
+int main(int argc, char** argv) {
+    CompileOptions opts = { .bake_pvs = true, .reorder = true };
+    const char* out_file = NULL;
+    const char* inputs[256];
+    int input_count = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-o") == 0 && i + 1 < argc) {
+            out_file = argv[++i];
+        } else if (strcmp(arg, "--no-pvs") == 0) {
+            opts.bake_pvs = false;
+        } else if (strcmp(arg, "--pvs") == 0) {
+            opts.bake_pvs = true; // The default; still accepted
+        } else if (strcmp(arg, "--no-reorder") == 0) {
+            opts.reorder = false;
+        } else if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            PrintUsage();
+            return 0;
+        } else if (arg[0] == '-') {
+            printf("boomer_mapc: Unknown option '%s'\n", arg);
+            PrintUsage();
+            return 1;
+        } else if (input_count < (int)(sizeof(inputs) / sizeof(inputs[0]))) {
+            inputs[input_count++] = arg;
+        }
+    }
+
+    if (input_count == 0 || (out_file && input_count > 1)) {
+        PrintUsage();
+        return 1;
+    }
+
+    int failed = 0;
+    for (int i = 0; i < input_count; ++i) {
+        char derived[512];
+        const char* target = out_file;
+        if (!target) {
+            // Swap the extension for .bmap
+            snprintf(derived, sizeof(derived), "%s", inputs[i]);
+            char* dot = strrchr(derived, '.');
+            char* slash = strrchr(derived, '/');
+            if (dot && (!slash || dot > slash)) *dot = '\0';
+            strncat(derived, ".bmap", sizeof(derived) - strlen(derived) - 1);
+            target = derived;
+        }
+        if (!Compile(inputs[i], target, &opts)) failed++;
+    }
+
+    return failed ? 1 : 0;
+}